@@ -0,0 +1,1516 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "INIAccess.h"
+#include "Try.h"
+
+static double BenchNow()
+{
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+// Results are also written to this file, one line per number, so runs of different versions can be compared
+static FILE *BenchResults;
+
+static void BenchRecord(const char *benchmark, const char *metric, double value, const char *unit)
+{
+    if(BenchResults != NULL)
+        fprintf(BenchResults, "%s,%s,%.6g,%s\n", benchmark, metric, value, unit);
+}
+
+enum BenchTypes
+{
+    BenchString = 1 << INITypeString,
+    BenchFloat = 1 << INITypeFloat,
+    BenchInt = 1 << INITypeInt
+};
+
+typedef struct BenchShape
+{
+    size_t SectionCount;
+    size_t KeyCount;
+    // Keys cycle through the set types in the order string, float, int
+    int Types;
+    // Strings are padded to at least this length
+    size_t ValueLength;
+    // A comment line follows every that many lines, 0 for none
+    size_t CommentEvery;
+} BenchShape;
+
+// Generates the same text for the same shape
+static char *BenchGenerateShape(const BenchShape *shape, size_t *length)
+{
+    enum INIType types[3];
+    size_t typeCount = 0;
+    for(enum INIType type = INITypeString; type <= INITypeInt; type++)
+    {
+        if(shape->Types & (1 << type))
+            types[typeCount++] = type;
+    }
+
+    if(typeCount == 0)
+        return NULL;
+
+    size_t lineSize = 48 + shape->ValueLength;
+    size_t lines = shape->SectionCount * (shape->KeyCount + 1);
+    size_t capacity = lines * lineSize + (shape->CommentEvery != 0 ? lines / shape->CommentEvery * 32 : 0) + 1;
+    char *text = malloc(capacity);
+    if(text == NULL)
+        return NULL;
+
+    size_t used = 0, line = 0;
+    for(size_t x = 0; x < shape->SectionCount; x++)
+    {
+        for(size_t y = 0; y <= shape->KeyCount; y++, line++)
+        {
+            if(y == 0)
+                used += snprintf(text + used, capacity - used, "[Section%zu]\n", x);
+            else
+            {
+                size_t key = y - 1;
+                switch(types[key % typeCount])
+                {
+                    case INITypeString:
+                    {
+                        int written = snprintf(text + used, capacity - used, "Key%zu = \"Value%zu", key, x * key);
+                        size_t valueLength = written - (size_t)snprintf(NULL, 0, "Key%zu = \"", key);
+                        used += written;
+                        for(; valueLength < shape->ValueLength; valueLength++)
+                            text[used++] = 'x';
+                        used += snprintf(text + used, capacity - used, "\"\n");
+                        break;
+                    }
+                    case INITypeFloat:
+                        used += snprintf(text + used, capacity - used, "Key%zu = %zu.5\n", key, x * key);
+                        break;
+                    default:
+                        used += snprintf(text + used, capacity - used, "Key%zu = %zu\n", key, x * key);
+                        break;
+                }
+            }
+
+            if(shape->CommentEvery != 0 && line % shape->CommentEvery == shape->CommentEvery - 1)
+                used += snprintf(text + used, capacity - used, "# Comment %zu\n", line);
+        }
+    }
+
+    *length = used;
+    return text;
+}
+
+// Strings and floats in turn, without comments
+static char *BenchGenerate(size_t sectionCount, size_t keyCount, size_t *length)
+{
+    BenchShape shape = {sectionCount, keyCount, BenchString | BenchFloat, 0, 0};
+    return BenchGenerateShape(&shape, length);
+}
+
+static int BenchWriteFile(const char *fileName, const char *text, size_t length)
+{
+    FILE *file = fopen(fileName, "wb");
+    if(file == NULL)
+        return -1;
+
+    size_t written = fwrite(text, 1, length, file);
+    return fclose(file) == 0 && written == length ? 0 : -1;
+}
+
+static double BenchParse(char *text, size_t length)
+{
+    INI INI = INIDefault;
+    INIEnableIndex(&INI);
+
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = text;
+    stream.IOStreamCount = length;
+
+    double start = BenchNow();
+    int code = INIStreamRead(&INI, &stream);
+    if(code == INIStreamStatusSuccess)
+        code = INIStreamRead(&INI, &stream);
+    double elapsed = BenchNow() - start;
+
+    INIStreamFree(&stream);
+    INIFree(&INI);
+
+    return code == INIStreamStatusSuccess ? elapsed : -1;
+}
+
+// Parses files of growing size, the time per line has to stay flat for parsing to be linear
+static int BenchParseScaling()
+{
+    const size_t sectionCounts[] = {1000, 4000, 16000, 64000};
+    const size_t keyCount = 4, repeats = 3;
+    const size_t count = sizeof(sectionCounts) / sizeof(*sectionCounts);
+    const double maxGrowth = 4;
+
+    double perLine[sizeof(sectionCounts) / sizeof(*sectionCounts)];
+
+    printf("Parse scaling\n");
+    for(size_t x = 0; x < count; x++)
+    {
+        size_t length;
+        char *text = BenchGenerate(sectionCounts[x], keyCount, &length);
+        if(text == NULL)
+            return -1;
+
+        double best = -1;
+        for(size_t y = 0; y < repeats; y++)
+        {
+            double elapsed = BenchParse(text, length);
+            if(elapsed >= 0 && (best < 0 || elapsed < best))
+                best = elapsed;
+        }
+
+        free(text);
+        if(best < 0)
+            return -1;
+
+        size_t lines = sectionCounts[x] * (keyCount + 1);
+        perLine[x] = best * 1e9 / lines;
+        printf("  %8zu sections %9zu lines %10.3f ms %8.1f ns/line\n", sectionCounts[x], lines, best * 1e3, perLine[x]);
+
+        char metric[64];
+        snprintf(metric, sizeof(metric), "%zu sections", sectionCounts[x]);
+        BenchRecord("ParseScaling", metric, perLine[x], "ns/line");
+    }
+
+    double growth = perLine[count - 1] / perLine[0];
+    printf("  Time per line grew %.2fx over a %zux larger file\n", growth, sectionCounts[count - 1] / sectionCounts[0]);
+
+    if(growth > maxGrowth)
+    {
+        printf("  Parsing no longer scales linearly\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+// Saves a large INI, which goes out in large unbuffered writes
+static int BenchWrite()
+{
+    const size_t sectionCount = 64000, keyCount = 4, repeats = 3;
+    const char *fileName = "Bin/BenchWrite.ini";
+
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL)
+        return -1;
+
+    INI INI = INIDefault;
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = text;
+    stream.IOStreamCount = length;
+
+    int code = INIStreamRead(&INI, &stream);
+    if(code == INIStreamStatusSuccess)
+        code = INIStreamRead(&INI, &stream);
+    INIStreamFree(&stream);
+
+    double best = -1;
+    for(size_t x = 0; x < repeats && code == INIStreamStatusSuccess; x++)
+    {
+        double start = BenchNow();
+        code = INIWrite(&INI, (char *)fileName);
+        double elapsed = BenchNow() - start;
+
+        if(best < 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    INIFree(&INI);
+    free(text);
+    remove(fileName);
+
+    if(code != INIStreamStatusSuccess)
+        return -1;
+
+    printf("Write\n");
+    printf("  %8zu sections %9zu bytes %10.3f ms %8.1f MB/s\n", sectionCount, length, best * 1e3, length / best * 1e-6);
+    BenchRecord("Write", "INIWrite", length / best * 1e-6, "MB/s");
+    return 0;
+}
+
+// Saving a change to one key of a large file by writing all of it against logging it to the journal
+static int BenchJournal()
+{
+    const size_t sectionCount = 64000, keyCount = 4, changes = 50;
+    const char *fileName = "Bin/BenchJournal.ini", *logName = "Bin/BenchJournal.ini.journal";
+
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL)
+        return -1;
+
+    int code = BenchWriteFile(fileName, text, length);
+    free(text);
+    remove(logName);
+
+    INI INI = INIDefault;
+    INIEnableIndex(&INI);
+    if(code == 0)
+        code = INIRead(&INI, (char *)fileName);
+
+    INISection *section = code == 0 ? INIFindSection(&INI, "Section0") : NULL;
+    double written = -1, journaled = -1, synced = -1;
+
+    if(section != NULL)
+    {
+        double start = BenchNow();
+        for(size_t x = 0; x < changes && code == 0; x++)
+        {
+            code = INIFindAndSetString(&INI, section, "Key0", x % 2 ? "changed" : "again");
+            if(code == 0)
+                code = INIWrite(&INI, (char *)fileName);
+        }
+        written = BenchNow() - start;
+
+        for(int sync = 0; sync < 2 && code == 0; sync++)
+        {
+            code = INIEnableJournal(&INI, sync ? INIJournalSyncAlways : INIJournalSyncNone, 0);
+            if(code == 0)
+                code = INIReset(&INI);
+            if(code == 0)
+                code = INIRead(&INI, (char *)fileName);
+
+            section = INIFindSection(&INI, "Section0");
+            start = BenchNow();
+            for(size_t x = 0; x < changes && code == 0; x++)
+                code = INIFindAndSetString(&INI, section, "Key0", x % 2 ? "changed" : "again");
+            *(sync ? &synced : &journaled) = BenchNow() - start;
+        }
+    }
+
+    INIFree(&INI);
+    remove(fileName);
+    remove(logName);
+
+    if(code != 0 || section == NULL)
+        return -1;
+
+    printf("Journal\n");
+    printf("  INIWrite %10.3f ms/change, journal %8.3f us/change, synced %8.3f us/change\n", written * 1e3 / changes, journaled * 1e6 / changes, synced * 1e6 / changes);
+    BenchRecord("Journal", "INIWrite", written * 1e3 / changes, "ms");
+    BenchRecord("Journal", "Journal", journaled * 1e6 / changes, "us");
+    BenchRecord("Journal", "Journal synced", synced * 1e6 / changes, "us");
+    return 0;
+}
+
+// Reads files of different shapes with INIRead
+static int BenchRead()
+{
+    const size_t repeats = 3;
+    const char *source = "Bin/BenchRead.ini";
+    const struct
+    {
+        const char *Name;
+        BenchShape Shape;
+    } shapes[] =
+    {
+        {"Mixed", {64000, 4, BenchString | BenchFloat | BenchInt, 0, 0}},
+        {"Strings", {64000, 4, BenchString, 0, 0}},
+        {"Ints", {64000, 4, BenchInt, 0, 0}},
+        {"Floats", {64000, 4, BenchFloat, 0, 0}},
+        {"LongLines", {16000, 4, BenchString, 200, 0}},
+        {"ManyKeys", {1000, 256, BenchString | BenchInt, 0, 0}},
+        {"Comments", {64000, 4, BenchString | BenchFloat | BenchInt, 0, 2}}
+    };
+
+    printf("Read\n");
+    for(size_t x = 0; x < sizeof(shapes) / sizeof(*shapes); x++)
+    {
+        size_t length;
+        char *text = BenchGenerateShape(&shapes[x].Shape, &length);
+        if(text == NULL)
+            return -1;
+
+        int code = BenchWriteFile(source, text, length);
+        free(text);
+
+        double best = -1;
+        for(size_t y = 0; y < repeats && code == 0; y++)
+        {
+            INI INI = INIDefault;
+            double start = BenchNow();
+            INIEnableIndex(&INI);
+            code = INIRead(&INI, (char *)source);
+            double elapsed = BenchNow() - start;
+            INIFree(&INI);
+
+            if(best < 0 || elapsed < best)
+                best = elapsed;
+        }
+
+        remove(source);
+        if(code != 0)
+            return -1;
+
+        size_t lines = shapes[x].Shape.SectionCount * (shapes[x].Shape.KeyCount + 1);
+        printf("  %-10s %9zu bytes %10.3f ms %8.1f MB/s %8.1f ns/line\n", shapes[x].Name, length, best * 1e3, length / best * 1e-6, best * 1e9 / lines);
+
+        BenchRecord("Read", shapes[x].Name, length / best * 1e-6, "MB/s");
+        BenchRecord("Read", shapes[x].Name, best * 1e9 / lines, "ns/line");
+    }
+
+    return 0;
+}
+
+// Feeds the same text to INIStreamRead in chunks of different sizes, lines split between chunks are buffered
+static int BenchStreamChunks()
+{
+    const size_t chunkSizes[] = {64, 1024, 16384, 262144, 1 << 24};
+    const size_t repeats = 3;
+    BenchShape shape = {64000, 4, BenchString | BenchFloat | BenchInt, 0, 0};
+
+    size_t length;
+    char *text = BenchGenerateShape(&shape, &length);
+    if(text == NULL)
+        return -1;
+
+    printf("Stream chunks\n");
+    int code = INIStreamStatusSuccess;
+    for(size_t x = 0; x < sizeof(chunkSizes) / sizeof(*chunkSizes) && code == INIStreamStatusSuccess; x++)
+    {
+        double best = -1;
+        for(size_t y = 0; y < repeats && code == INIStreamStatusSuccess; y++)
+        {
+            INI INI = INIDefault;
+            INIStream stream = INIStreamDefault;
+
+            double start = BenchNow();
+            INIEnableIndex(&INI);
+            for(size_t offset = 0; offset < length && code == INIStreamStatusSuccess; offset += chunkSizes[x])
+            {
+                stream.IOStream = text + offset;
+                stream.IOStreamCount = length - offset < chunkSizes[x] ? length - offset : chunkSizes[x];
+                code = INIStreamRead(&INI, &stream);
+            }
+
+            // The end of the input parses the last line
+            stream.IOStreamCount = 0;
+            if(code == INIStreamStatusSuccess)
+                code = INIStreamRead(&INI, &stream);
+            double elapsed = BenchNow() - start;
+
+            INIStreamFree(&stream);
+            INIFree(&INI);
+
+            if(best < 0 || elapsed < best)
+                best = elapsed;
+        }
+
+        if(code == INIStreamStatusSuccess)
+        {
+            printf("  %8zu byte chunks %10.3f ms %8.1f MB/s\n", chunkSizes[x], best * 1e3, length / best * 1e-6);
+
+            char metric[64];
+            snprintf(metric, sizeof(metric), "%zu byte chunks", chunkSizes[x]);
+            BenchRecord("StreamChunks", metric, length / best * 1e-6, "MB/s");
+        }
+    }
+
+    free(text);
+    return code == INIStreamStatusSuccess ? 0 : -1;
+}
+
+// Compares parsing a large file against loading its binary image
+static int BenchBinary()
+{
+    const size_t sectionCount = 64000, keyCount = 4, repeats = 3;
+    const char *source = "Bin/BenchSource.ini", *image = "Bin/BenchSource.bin";
+
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL)
+        return -1;
+
+    int written = BenchWriteFile(source, text, length);
+    free(text);
+    if(written != 0)
+        return -1;
+
+    // Both sides build the index, without it every added section is checked against all earlier ones
+    INI INI = INIDefault;
+    INIEnableIndex(&INI);
+    int code = INIRead(&INI, (char *)source);
+    if(code == 0)
+        code = INISaveBinary(&INI, (char *)image, (char *)source);
+    INIFree(&INI);
+
+    double bestText = -1, bestBinary = -1, bestMapped = -1;
+    for(size_t x = 0; x < repeats && code == 0; x++)
+    {
+        double start = BenchNow();
+        INIEnableIndex(&INI);
+        code = INIRead(&INI, (char *)source);
+        double elapsed = BenchNow() - start;
+        INIFree(&INI);
+
+        if(bestText < 0 || elapsed < bestText)
+            bestText = elapsed;
+
+        start = BenchNow();
+        INIEnableIndex(&INI);
+        if(code == 0)
+            code = INILoadBinary(&INI, (char *)image, (char *)source);
+        elapsed = BenchNow() - start;
+        INIFree(&INI);
+
+        if(bestBinary < 0 || elapsed < bestBinary)
+            bestBinary = elapsed;
+
+        // Without the index, loading is only the checksum and turning offsets into pointers
+        start = BenchNow();
+        if(code == 0)
+            code = INILoadBinary(&INI, (char *)image, (char *)source);
+        elapsed = BenchNow() - start;
+        INIFree(&INI);
+
+        if(bestMapped < 0 || elapsed < bestMapped)
+            bestMapped = elapsed;
+    }
+
+    remove(source);
+    remove(image);
+
+    if(code != 0)
+        return -1;
+
+    printf("Binary\n");
+    printf("  INIRead %10.3f ms, INILoadBinary %10.3f ms, %10.3f ms without the index\n", bestText * 1e3, bestBinary * 1e3, bestMapped * 1e3);
+    BenchRecord("Binary", "INIRead", bestText * 1e3, "ms");
+    BenchRecord("Binary", "INILoadBinary", bestBinary * 1e3, "ms");
+    BenchRecord("Binary", "INILoadBinary without index", bestMapped * 1e3, "ms");
+    return 0;
+}
+
+static int BenchCountPair(void *context, const char *key, size_t keyLength, const char *value, size_t valueLength, enum INIType type)
+{
+    (void)key, (void)keyLength, (void)value, (void)valueLength, (void)type;
+    (*(size_t *)context)++;
+    return 0;
+}
+
+static int BenchEvents()
+{
+    const size_t sectionCount = 64000, keyCount = 4, repeats = 3;
+    const char *source = "Bin/BenchEvents.ini";
+
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL)
+        return -1;
+
+    int written = BenchWriteFile(source, text, length);
+    free(text);
+    if(written != 0)
+        return -1;
+
+    size_t pairs = 0;
+    INIHandlers handlers = {.Context = &pairs, .Pair = BenchCountPair};
+
+    int code = 0;
+    double bestRead = -1, bestParse = -1;
+    for(size_t x = 0; x < repeats && code == 0; x++)
+    {
+        INI INI = INIDefault;
+        double start = BenchNow();
+        INIEnableIndex(&INI);
+        code = INIRead(&INI, (char *)source);
+        double elapsed = BenchNow() - start;
+        INIFree(&INI);
+
+        if(bestRead < 0 || elapsed < bestRead)
+            bestRead = elapsed;
+
+        pairs = 0;
+        start = BenchNow();
+        if(code == 0)
+            code = INIParse((char *)source, &handlers);
+        elapsed = BenchNow() - start;
+
+        if(bestParse < 0 || elapsed < bestParse)
+            bestParse = elapsed;
+    }
+
+    remove(source);
+
+    if(code != 0 || pairs != sectionCount * keyCount)
+        return -1;
+
+    printf("Events\n");
+    printf("  INIRead %10.3f ms, INIParse %10.3f ms\n", bestRead * 1e3, bestParse * 1e3);
+    BenchRecord("Events", "INIRead", bestRead * 1e3, "ms");
+    BenchRecord("Events", "INIParse", bestParse * 1e3, "ms");
+    return 0;
+}
+
+static int BenchLazy()
+{
+    const size_t sectionCount = 64000, keyCount = 8, repeats = 3;
+    const char *source = "Bin/BenchLazy.ini";
+
+    // Floats with all their digits, as written by INIWrite
+    FILE *file = fopen(source, "w");
+    if(file == NULL)
+        return -1;
+
+    uint64_t state = 88172645463325252u;
+    for(size_t x = 0; x < sectionCount; x++)
+    {
+        fprintf(file, "[Section%zu]\n", x);
+        for(size_t y = 0; y < keyCount; y++)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            char number[INIFloatBufferSize];
+            INIFormatFloat((double)(state >> 11) * 0x1p-40, number);
+            fprintf(file, "Key%zu = %s\n", y, number);
+        }
+    }
+
+    fclose(file);
+
+    int code = 0;
+    double best[2] = {-1, -1}, sum[2] = {0, 0};
+    for(size_t x = 0; x < repeats && code == 0; x++)
+    {
+        for(int lazy = 0; lazy < 2 && code == 0; lazy++)
+        {
+            INI INI = INIDefault;
+            double start = BenchNow();
+            INIEnableIndex(&INI);
+            if(lazy)
+                INIEnableLazyValues(&INI);
+            code = INIReadMapped(&INI, (char *)source);
+
+            // Touches one key in twenty
+            size_t touched = 0;
+            for(INISection *section = INI.FirstSection; section != NULL; section = section->NextSection)
+            {
+                for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair, touched++)
+                {
+                    if(touched % 20 == 0)
+                        sum[lazy] += *INIGetFloat(pair);
+                }
+            }
+
+            double elapsed = BenchNow() - start;
+            INIFree(&INI);
+
+            if(best[lazy] < 0 || elapsed < best[lazy])
+                best[lazy] = elapsed;
+        }
+    }
+
+    remove(source);
+
+    if(code != 0 || sum[0] != sum[1])
+        return -1;
+
+    printf("Lazy values, %zu floats with 5%% read\n", sectionCount * keyCount);
+    printf("  Eager %10.3f ms, lazy %10.3f ms, %5.2fx\n", best[0] * 1e3, best[1] * 1e3, best[0] / best[1]);
+    BenchRecord("Lazy", "Eager", best[0] * 1e3, "ms");
+    BenchRecord("Lazy", "Lazy", best[1] * 1e3, "ms");
+    return 0;
+}
+
+// Reads many sections with the same keys with and without interning, then looks the keys of one section up
+static int BenchInterning()
+{
+    const size_t sectionCount = 64000, keyCount = 8, repeats = 3, lookups = 4000000;
+
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL)
+        return -1;
+
+    char names[8][8];
+    for(size_t x = 0; x < keyCount; x++)
+        snprintf(names[x], sizeof(names[x]), "Key%zu", x);
+
+    int code = 0;
+    double best[2] = {-1, -1}, lookup[2] = {-1, -1};
+    size_t keyBytes[2] = {0, 0}, found = 0;
+
+    for(size_t x = 0; x < repeats && code == 0; x++)
+    {
+        for(int interned = 0; interned < 2 && code == 0; interned++)
+        {
+            INI INI = INIDefault;
+            INIEnableIndex(&INI);
+            if(interned)
+                INIEnableInterning(&INI);
+
+            INIStream stream = INIStreamDefault;
+            stream.IOStream = text;
+            stream.IOStreamCount = length;
+
+            double start = BenchNow();
+            code = INIStreamRead(&INI, &stream);
+            if(code == INIStreamStatusSuccess)
+                code = INIStreamRead(&INI, &stream);
+            double elapsed = BenchNow() - start;
+            INIStreamFree(&stream);
+
+            if(best[interned] < 0 || elapsed < best[interned])
+                best[interned] = elapsed;
+
+            // Counts every copy of a key that is not the one the first section uses
+            keyBytes[interned] = 0;
+            for(INISection *section = INI.FirstSection; section != NULL && code == 0; section = section->NextSection)
+            {
+                INIPair *first = INI.FirstSection->FirstPair;
+                for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair, first = first->NextPair)
+                    keyBytes[interned] += section == INI.FirstSection || pair->Key != first->Key ? strlen(pair->Key) + 1 : 0;
+            }
+
+            INIKey keys[8];
+            for(size_t y = 0; y < keyCount && code == 0; y++)
+            {
+                if(interned)
+                    code = INIInternKey(&INI, names[y], keys + y);
+                else
+                    keys[y] = INIKeyMake(names[y]);
+            }
+
+            if(code == 0)
+            {
+                start = BenchNow();
+                for(size_t y = 0; y < lookups; y++)
+                    found += INIFindPairByKey(INI.LastSection, keys + y % keyCount) != NULL;
+                elapsed = BenchNow() - start;
+
+                if(lookup[interned] < 0 || elapsed < lookup[interned])
+                    lookup[interned] = elapsed;
+            }
+
+            INIFree(&INI);
+        }
+    }
+
+    free(text);
+
+    if(code != 0 || found != 2 * repeats * lookups)
+        return -1;
+
+    printf("Interning, %zu sections with %zu keys each\n", sectionCount, keyCount);
+    printf("  Copied   %10.3f ms %9zu key bytes %6.1f ns/lookup\n", best[0] * 1e3, keyBytes[0], lookup[0] * 1e9 / lookups);
+    printf("  Interned %10.3f ms %9zu key bytes %6.1f ns/lookup\n", best[1] * 1e3, keyBytes[1], lookup[1] * 1e9 / lookups);
+    BenchRecord("Interning", "Copied read", best[0] * 1e3, "ms");
+    BenchRecord("Interning", "Interned read", best[1] * 1e3, "ms");
+    BenchRecord("Interning", "Copied key bytes", keyBytes[0], "bytes");
+    BenchRecord("Interning", "Interned key bytes", keyBytes[1], "bytes");
+    BenchRecord("Interning", "Copied lookup", lookup[0] * 1e9 / lookups, "ns");
+    BenchRecord("Interning", "Interned lookup", lookup[1] * 1e9 / lookups, "ns");
+    return 0;
+}
+
+static int BenchParallel()
+{
+    const size_t sectionCount = 256000, keyCount = 4, repeats = 3;
+    const int threadCounts[] = {1, 2, 4, 8, 16};
+    const char *source = "Bin/BenchParallel.ini";
+
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL)
+        return -1;
+
+    int written = BenchWriteFile(source, text, length);
+    free(text);
+    if(written != 0)
+        return -1;
+
+    printf("Parallel read of %zu sections, %.1f MB\n", sectionCount, length / 1e6);
+
+    INI INI = INIDefault;
+    int code = 0;
+    double bestSequential = -1;
+    for(size_t x = 0; x < repeats && code == 0; x++)
+    {
+        double start = BenchNow();
+        INIEnableIndex(&INI);
+        code = INIReadMapped(&INI, (char *)source);
+        double elapsed = BenchNow() - start;
+        INIFree(&INI);
+
+        if(bestSequential < 0 || elapsed < bestSequential)
+            bestSequential = elapsed;
+    }
+
+    if(code == 0)
+    {
+        printf("  INIReadMapped  %10.3f ms\n", bestSequential * 1e3);
+        BenchRecord("Parallel", "INIReadMapped", bestSequential * 1e3, "ms");
+    }
+
+    for(size_t x = 0; x < sizeof(threadCounts) / sizeof(*threadCounts) && code == 0; x++)
+    {
+        double best = -1;
+        for(size_t y = 0; y < repeats && code == 0; y++)
+        {
+            double start = BenchNow();
+            INIEnableIndex(&INI);
+            code = INIReadParallel(&INI, (char *)source, threadCounts[x]);
+            double elapsed = BenchNow() - start;
+            INIFree(&INI);
+
+            if(best < 0 || elapsed < best)
+                best = elapsed;
+        }
+
+        printf("  %2d threads     %10.3f ms, %5.2fx\n", threadCounts[x], best * 1e3, bestSequential / best);
+
+        char metric[64];
+        snprintf(metric, sizeof(metric), "%d threads", threadCounts[x]);
+        BenchRecord("Parallel", metric, best * 1e3, "ms");
+    }
+
+    remove(source);
+    return code == 0 ? 0 : -1;
+}
+
+typedef struct BenchLookup
+{
+    char Section[16];
+    char Key[8];
+} BenchLookup;
+
+static double BenchLookups(INI *INI, const BenchLookup *names, size_t nameCount, size_t lookups)
+{
+    size_t found = 0;
+
+    double start = BenchNow();
+    for(size_t x = 0; x < lookups; x++)
+    {
+        const BenchLookup *name = names + x % nameCount;
+        INISection *section = INIFindSection(INI, (char *)name->Section);
+        if(section != NULL && INIFindPair(section, (char *)name->Key) != NULL)
+            found++;
+    }
+    double elapsed = BenchNow() - start;
+
+    return found == lookups ? elapsed : -1;
+}
+
+typedef struct BenchKey
+{
+    INIKey Section;
+    INIKey Key;
+} BenchKey;
+
+static double BenchKeyLookups(INI *INI, const BenchKey *keys, size_t keyCount, size_t lookups)
+{
+    size_t found = 0;
+
+    double start = BenchNow();
+    for(size_t x = 0; x < lookups; x++)
+    {
+        const BenchKey *key = keys + x % keyCount;
+        INISection *section = INIFindSectionByKey(INI, &key->Section);
+        if(section != NULL && INIFindPairByKey(section, &key->Key) != NULL)
+            found++;
+    }
+    double elapsed = BenchNow() - start;
+
+    return found == lookups ? elapsed : -1;
+}
+
+// Times one kind of lookup over the names, every one of which has to be found or missed as expected
+static double BenchFindKind(INI *INI, INISection *section, const BenchLookup *names, size_t nameCount, size_t lookups, int pairs, int hit)
+{
+    size_t matched = 0;
+
+    double start = BenchNow();
+    for(size_t x = 0; x < lookups; x++)
+    {
+        const BenchLookup *name = names + x % nameCount;
+        if(pairs)
+            matched += (INIFindPair(section, (char *)name->Key) != NULL) == hit;
+        else
+            matched += (INIFindSection(INI, (char *)name->Section) != NULL) == hit;
+    }
+    double elapsed = BenchNow() - start;
+
+    return matched == lookups ? elapsed : -1;
+}
+
+// Hits and misses of INIFindSection and INIFindPair with the index, and of INIFindPair scanning a section without it
+static int BenchFind()
+{
+    const size_t sectionCount = 64000, keyCount = 16, lookups = 4000000, nameCount = 1 << 12;
+
+    BenchLookup *hits = malloc(nameCount * sizeof(*hits)), *misses = malloc(nameCount * sizeof(*misses));
+    BenchShape shape = {sectionCount, keyCount, BenchString | BenchInt, 0, 0};
+    size_t length;
+    char *text = BenchGenerateShape(&shape, &length);
+    if(text == NULL || hits == NULL || misses == NULL)
+    {
+        free(text);
+        free(hits);
+        free(misses);
+        return -1;
+    }
+
+    uint64_t state = 88172645463325252u;
+    for(size_t x = 0; x < nameCount; x++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        snprintf(hits[x].Section, sizeof(hits[x].Section), "Section%zu", (size_t)(state % sectionCount));
+        snprintf(hits[x].Key, sizeof(hits[x].Key), "Key%zu", (size_t)(state >> 32) % keyCount);
+        snprintf(misses[x].Section, sizeof(misses[x].Section), "Missing%zu", (size_t)(state % sectionCount));
+        snprintf(misses[x].Key, sizeof(misses[x].Key), "Key%zu", keyCount + (size_t)(state >> 32) % keyCount);
+    }
+
+    INI indexed = INIDefault, scanned = INIDefault;
+    INIEnableIndex(&indexed);
+
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = text;
+    stream.IOStreamCount = length;
+
+    int code = INIStreamRead(&indexed, &stream);
+    if(code == INIStreamStatusSuccess)
+        code = INIStreamRead(&indexed, &stream);
+    INIStreamFree(&stream);
+    free(text);
+
+    // A single section is enough for scanning
+    INISection *section = indexed.LastSection, *scannedSection = INIAddSection(&scanned, "Section");
+    for(INIPair *pair = section != NULL ? section->FirstPair : NULL; pair != NULL && scannedSection != NULL; pair = pair->NextPair)
+    {
+        if(INIAddInt(&scanned, scannedSection, pair->Key, 1) == NULL)
+            code = -1;
+    }
+
+    const char *kinds[] = {"Section hit", "Section miss", "Pair hit", "Pair miss", "Scanned pair hit", "Scanned pair miss"};
+    double times[6];
+    for(int x = 0; x < 6 && code == INIStreamStatusSuccess && scannedSection != NULL; x++)
+    {
+        int hit = x % 2 == 0, pairs = x >= 2;
+        times[x] = BenchFindKind(&indexed, x < 4 ? section : scannedSection, hit ? hits : misses, nameCount, lookups, pairs, hit);
+        if(times[x] < 0)
+            code = -1;
+    }
+
+    if(scannedSection == NULL)
+        code = -1;
+
+    INIFree(&indexed);
+    INIFree(&scanned);
+    free(hits);
+    free(misses);
+
+    if(code != INIStreamStatusSuccess)
+        return -1;
+
+    printf("Find, %zu sections with %zu keys\n", sectionCount, keyCount);
+    for(int x = 0; x < 6; x++)
+    {
+        printf("  %-18s %8.1f ns/op\n", kinds[x], times[x] * 1e9 / lookups);
+        BenchRecord("Find", kinds[x], times[x] * 1e9 / lookups, "ns");
+    }
+
+    return 0;
+}
+
+// Compares random section and key lookups through the hash index with the sorted tables of a frozen INI
+static int BenchFreeze()
+{
+    const size_t sectionCount = 64000, keyCount = 4, lookups = 4000000, nameCount = 1 << 16;
+
+    // Names are formatted up front, so only the lookups are timed
+    BenchLookup *names = malloc(nameCount * sizeof(*names));
+    BenchKey *keys = malloc(nameCount * sizeof(*keys));
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL || names == NULL || keys == NULL)
+    {
+        free(text);
+        free(names);
+        free(keys);
+        return -1;
+    }
+
+    uint64_t state = 88172645463325252u;
+    for(size_t x = 0; x < nameCount; x++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        snprintf(names[x].Section, sizeof(names[x].Section), "Section%zu", (size_t)(state % sectionCount));
+        snprintf(names[x].Key, sizeof(names[x].Key), "Key%zu", (size_t)(state >> 32) % keyCount);
+        keys[x].Section = INIKeyMake(names[x].Section);
+        keys[x].Key = INIKeyMake(names[x].Key);
+    }
+
+    INI INI = INIDefault;
+    INIEnableIndex(&INI);
+
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = text;
+    stream.IOStreamCount = length;
+
+    int code = INIStreamRead(&INI, &stream);
+    if(code == INIStreamStatusSuccess)
+        code = INIStreamRead(&INI, &stream);
+    INIStreamFree(&stream);
+    free(text);
+
+    double indexed = code == INIStreamStatusSuccess ? BenchLookups(&INI, names, nameCount, lookups) : -1;
+    double indexedKeys = indexed >= 0 ? BenchKeyLookups(&INI, keys, nameCount, lookups) : -1;
+    double frozen = -1, frozenKeys = -1;
+
+    if(indexedKeys >= 0 && INIFreeze(&INI) == 0)
+    {
+        frozen = BenchLookups(&INI, names, nameCount, lookups);
+        frozenKeys = BenchKeyLookups(&INI, keys, nameCount, lookups);
+    }
+
+    INIFree(&INI);
+    free(names);
+    free(keys);
+
+    if(frozen < 0 || frozenKeys < 0)
+        return -1;
+
+    printf("Lookups\n");
+    printf("  Index %8.1f ns/lookup, frozen %8.1f ns/lookup\n", indexed * 1e9 / lookups, frozen * 1e9 / lookups);
+    printf("  Keys  %8.1f ns/lookup, frozen %8.1f ns/lookup\n", indexedKeys * 1e9 / lookups, frozenKeys * 1e9 / lookups);
+    BenchRecord("Lookups", "Index", indexed * 1e9 / lookups, "ns");
+    BenchRecord("Lookups", "Frozen", frozen * 1e9 / lookups, "ns");
+    BenchRecord("Lookups", "Index keys", indexedKeys * 1e9 / lookups, "ns");
+    BenchRecord("Lookups", "Frozen keys", frozenKeys * 1e9 / lookups, "ns");
+    return 0;
+}
+
+// Fetching a schema worth of keys from one section one by one against INIFindValues, with and without the index
+static int BenchFindValues()
+{
+    const size_t keyCount = 100, wanted = 60, rounds = 100000;
+
+    char keys[100][8];
+    INILookup lookups[60];
+    for(size_t x = 0; x < keyCount; x++)
+        snprintf(keys[x], sizeof(keys[x]), "Key%zu", x);
+    for(size_t x = 0; x < wanted; x++)
+        lookups[x] = (INILookup){.Key = keys[(x * 7) % keyCount], .Type = INITypeInt};
+
+    printf("Find values\n");
+    for(int indexed = 0; indexed < 2; indexed++)
+    {
+        INI INI = INIDefault;
+        if(indexed)
+            INIEnableIndex(&INI);
+
+        INISection *section = INIAddSection(&INI, "Section");
+        for(size_t x = 0; x < keyCount && section != NULL; x++)
+        {
+            if(INIAddInt(&INI, section, keys[x], x) == NULL)
+                section = NULL;
+        }
+
+        if(section == NULL)
+        {
+            INIFree(&INI);
+            return -1;
+        }
+
+        size_t found = 0;
+        double start = BenchNow();
+        for(size_t round = 0; round < rounds; round++)
+        {
+            for(size_t x = 0; x < wanted; x++)
+                found += INIFindInt(section, lookups[x].Key) != NULL;
+        }
+        double single = BenchNow() - start;
+
+        start = BenchNow();
+        for(size_t round = 0; round < rounds; round++)
+            found += INIFindValues(section, lookups, wanted);
+        double batched = BenchNow() - start;
+
+        INIFree(&INI);
+        if(found != 2 * rounds * wanted)
+            return -1;
+
+        const char *kind = indexed ? "Index" : "Scan";
+        printf("  %-5s one by one %8.3f us, batched %8.3f us\n", kind, single * 1e6 / rounds, batched * 1e6 / rounds);
+
+        char metric[64];
+        snprintf(metric, sizeof(metric), "%s one by one", kind);
+        BenchRecord("Find values", metric, single * 1e6 / rounds, "us");
+        snprintf(metric, sizeof(metric), "%s batched", kind);
+        BenchRecord("Find values", metric, batched * 1e6 / rounds, "us");
+    }
+
+    return 0;
+}
+
+// Lookups through a base INI with a small INI on top, against lookups in the base alone, and flattening the two
+static int BenchOverlay()
+{
+    const size_t sectionCount = 64000, keyCount = 4, overrideCount = 1000, lookups = 4000000, nameCount = 1 << 16;
+
+    BenchLookup *names = malloc(nameCount * sizeof(*names));
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL || names == NULL)
+    {
+        free(text);
+        free(names);
+        return -1;
+    }
+
+    uint64_t state = 88172645463325252u;
+    for(size_t x = 0; x < nameCount; x++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        snprintf(names[x].Section, sizeof(names[x].Section), "Section%zu", (size_t)(state % sectionCount));
+        snprintf(names[x].Key, sizeof(names[x].Key), "Key%zu", (size_t)(state >> 32) % keyCount);
+    }
+
+    INI base = INIDefault, top = INIDefault, flat = INIDefault;
+    INIEnableIndex(&base);
+    INIEnableIndex(&top);
+    INIEnableIndex(&flat);
+
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = text;
+    stream.IOStreamCount = length;
+
+    int code = INIStreamRead(&base, &stream);
+    if(code == INIStreamStatusSuccess)
+        code = INIStreamRead(&base, &stream);
+    INIStreamFree(&stream);
+    free(text);
+
+    for(size_t x = 0; x < overrideCount && code == 0; x++)
+    {
+        char sectionName[32];
+        snprintf(sectionName, sizeof(sectionName), "Section%zu", x * (sectionCount / overrideCount));
+        INISection *section = INIAddSection(&top, sectionName);
+        code = section != NULL && INIAddInt(&top, section, "Key0", x) != NULL ? 0 : -1;
+    }
+
+    INIOverlay *overlay = INIOverlayCreate();
+    if(overlay == NULL || INIOverlayAdd(overlay, &base) != 0 || INIOverlayAdd(overlay, &top) != 0)
+        code = -1;
+
+    double direct = code == 0 ? BenchLookups(&base, names, nameCount, lookups) : -1;
+    double layered = -1, flatten = -1;
+
+    if(direct >= 0)
+    {
+        size_t found = 0;
+        double start = BenchNow();
+        for(size_t x = 0; x < lookups; x++)
+        {
+            const BenchLookup *name = names + x % nameCount;
+            found += INIOverlayFindPair(overlay, (char *)name->Section, (char *)name->Key) != NULL;
+        }
+        layered = found == lookups ? BenchNow() - start : -1;
+
+        start = BenchNow();
+        if(INIFlatten(overlay, &flat) == 0)
+            flatten = BenchNow() - start;
+    }
+
+    if(overlay != NULL)
+        INIOverlayFree(overlay);
+    INIFree(&base);
+    INIFree(&top);
+    INIFree(&flat);
+    free(names);
+
+    if(layered < 0 || flatten < 0)
+        return -1;
+
+    printf("Overlay\n");
+    printf("  Base alone %8.1f ns/lookup, overlay %8.1f ns/lookup\n", direct * 1e9 / lookups, layered * 1e9 / lookups);
+    printf("  INIFlatten %8.3f ms\n", flatten * 1e3);
+    BenchRecord("Overlay", "Base lookup", direct * 1e9 / lookups, "ns");
+    BenchRecord("Overlay", "Overlay lookup", layered * 1e9 / lookups, "ns");
+    BenchRecord("Overlay", "INIFlatten", flatten * 1e3, "ms");
+    return 0;
+}
+
+// Compares a clone with a few changes to copying the whole INI, which is what per request views cost without clones
+static int BenchClone()
+{
+    const size_t sectionCount = 64000, keyCount = 4, clones = 100, editCount = 3, lookups = 4000000, nameCount = 1 << 16;
+
+    BenchLookup *names = malloc(nameCount * sizeof(*names));
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL || names == NULL)
+    {
+        free(text);
+        free(names);
+        return -1;
+    }
+
+    uint64_t state = 88172645463325252u;
+    for(size_t x = 0; x < nameCount; x++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        snprintf(names[x].Section, sizeof(names[x].Section), "Section%zu", (size_t)(state % sectionCount));
+        snprintf(names[x].Key, sizeof(names[x].Key), "Key%zu", (size_t)(state >> 32) % keyCount);
+    }
+
+    INI base = INIDefault, clone = INIDefault;
+    INIEnableIndex(&base);
+
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = text;
+    stream.IOStreamCount = length;
+
+    int code = INIStreamRead(&base, &stream);
+    if(code == INIStreamStatusSuccess)
+        code = INIStreamRead(&base, &stream);
+    INIStreamFree(&stream);
+    free(text);
+
+    if(code == 0)
+        code = INIFreeze(&base);
+
+    double cloned = -1, copied = -1, lookup = -1;
+    if(code == 0)
+    {
+        double start = BenchNow();
+        for(size_t x = 0; x < clones && code == 0; x++)
+        {
+            code = INIClone(&base, &clone);
+            for(size_t y = 0; y < editCount && code == 0; y++)
+            {
+                char sectionName[32];
+                snprintf(sectionName, sizeof(sectionName), "Section%zu", (x * editCount + y) * 97 % sectionCount);
+                code = INIFindAndSetInt(&clone, INIFindSection(&clone, sectionName), "Key0", (int64_t)x);
+            }
+            if(x + 1 < clones)
+                INIFree(&clone);
+        }
+        cloned = code == 0 ? BenchNow() - start : -1;
+    }
+
+    if(cloned >= 0)
+        lookup = BenchLookups(&clone, names, nameCount, lookups);
+
+    INIOverlay *overlay = INIOverlayCreate();
+    if(lookup >= 0 && overlay != NULL && INIOverlayAdd(overlay, &base) == 0)
+    {
+        double start = BenchNow();
+        for(size_t x = 0; x < clones && code == 0; x++)
+        {
+            INI copy = INIDefault;
+            INIEnableIndex(&copy);
+            code = INIFlatten(overlay, &copy);
+            INIFree(&copy);
+        }
+        copied = code == 0 ? BenchNow() - start : -1;
+    }
+
+    if(overlay != NULL)
+        INIOverlayFree(overlay);
+    INIFree(&clone);
+    INIFree(&base);
+    free(names);
+
+    if(copied < 0)
+        return -1;
+
+    printf("Clone\n");
+    printf("  INIClone with %zu changes %8.3f ms, full copy %8.3f ms\n", editCount, cloned * 1e3 / clones, copied * 1e3 / clones);
+    printf("  Clone lookups %8.1f ns/lookup\n", lookup * 1e9 / lookups);
+    BenchRecord("Clone", "INIClone", cloned * 1e3 / clones, "ms");
+    BenchRecord("Clone", "Full copy", copied * 1e3 / clones, "ms");
+    BenchRecord("Clone", "Clone lookup", lookup * 1e9 / lookups, "ns");
+    return 0;
+}
+
+typedef struct BenchConfig
+{
+    char Strings[16][32];
+    double Floats[16];
+} BenchConfig;
+
+// Compares filling a struct key by key with INIFind* calls to INIBind, and reading the file first to INIBindFile
+static int BenchBind()
+{
+    const size_t sectionCount = 1000, keyCount = 4, fieldSections = 8, binds = 100000, files = 100;
+    const char *fileName = "Bin/BenchBind.ini";
+
+    size_t length;
+    char *text = BenchGenerate(sectionCount, keyCount, &length);
+    if(text == NULL)
+        return -1;
+
+    int code = BenchWriteFile(fileName, text, length);
+    free(text);
+
+    char names[16][2][16];
+    INIField fields[32];
+    size_t fieldCount = 0;
+    for(size_t x = 0; x < fieldSections; x++)
+    {
+        for(size_t y = 0; y < keyCount; y++, fieldCount++)
+        {
+            char *section = names[x][0], *key = names[y][1];
+            snprintf(section, sizeof(names[x][0]), "Section%zu", x * (sectionCount / fieldSections));
+            snprintf(key, sizeof(names[y][1]), "Key%zu", y);
+
+            // Even keys are strings and odd ones floats
+            size_t slot = x * 2 + y / 2;
+            fields[fieldCount] = y % 2 == 0 ? 
+                (INIField){section, key, INITypeString, offsetof(BenchConfig, Strings) + slot * sizeof(((BenchConfig *)0)->Strings[0]), sizeof(((BenchConfig *)0)->Strings[0]), 1, {.Int = 0}} : 
+                (INIField){section, key, INITypeFloat, offsetof(BenchConfig, Floats) + slot * sizeof(double), sizeof(double), 1, {.Int = 0}};
+        }
+    }
+
+    INI INI = INIDefault;
+    INIEnableIndex(&INI);
+    if(code == 0)
+        code = INIRead(&INI, (char *)fileName);
+
+    BenchConfig config;
+    double manual = -1, bound = -1, read = -1, streamed = -1;
+    if(code == 0)
+    {
+        double start = BenchNow();
+        for(size_t x = 0; x < binds && code == 0; x++)
+        {
+            for(size_t y = 0; y < fieldCount && code == 0; y++)
+            {
+                const INIField *field = fields + y;
+                INISection *section = INIFindSection(&INI, (char *)field->Section);
+                void *value = section != NULL ? INIFindValue(section, (char *)field->Key, field->Type) : NULL;
+                if(value == NULL)
+                    code = -1;
+                else if(field->Type == INITypeString)
+                    snprintf((char *)&config + field->Offset, field->Size, "%s", (char *)value);
+                else
+                    memcpy((char *)&config + field->Offset, value, sizeof(double));
+            }
+        }
+        manual = code == 0 ? BenchNow() - start : -1;
+
+        start = BenchNow();
+        for(size_t x = 0; x < binds && code == 0; x++)
+            code = INIBind(&INI, fields, fieldCount, &config, NULL);
+        bound = code == 0 ? BenchNow() - start : -1;
+    }
+    INIFree(&INI);
+
+    if(bound >= 0)
+    {
+        double start = BenchNow();
+        for(size_t x = 0; x < files && code == 0; x++)
+        {
+            INI = INIDefault;
+            INIEnableIndex(&INI);
+            code = INIRead(&INI, (char *)fileName) == 0 ? INIBind(&INI, fields, fieldCount, &config, NULL) : -1;
+            INIFree(&INI);
+        }
+        read = code == 0 ? BenchNow() - start : -1;
+
+        start = BenchNow();
+        for(size_t x = 0; x < files && code == 0; x++)
+            code = INIBindFile((char *)fileName, fields, fieldCount, &config, NULL);
+        streamed = code == 0 ? BenchNow() - start : -1;
+    }
+    remove(fileName);
+
+    if(streamed < 0)
+        return -1;
+
+    printf("Bind\n");
+    printf("  %zu fields with INIFind* %8.1f ns, INIBind %8.1f ns\n", fieldCount, manual * 1e9 / binds, bound * 1e9 / binds);
+    printf("  INIRead and INIBind %8.3f ms, INIBindFile %8.3f ms\n", read * 1e3 / files, streamed * 1e3 / files);
+    BenchRecord("Bind", "INIFind per field", manual * 1e9 / binds, "ns");
+    BenchRecord("Bind", "INIBind", bound * 1e9 / binds, "ns");
+    BenchRecord("Bind", "INIRead and INIBind", read * 1e3 / files, "ms");
+    BenchRecord("Bind", "INIBindFile", streamed * 1e3 / files, "ms");
+    return 0;
+}
+
+// Measures what readers of a handle pay per acquire and release
+static int BenchHandle()
+{
+    const size_t rounds = 10000000;
+
+    INIHandle *handle = INIHandleCreate(1);
+    INI *INI = malloc(sizeof(*INI));
+    if(handle == NULL || INI == NULL || (*INI = INIDefault, INIHandlePublish(handle, INI)) != 0)
+    {
+        free(INI);
+        if(handle != NULL)
+            INIHandleFree(handle);
+        return -1;
+    }
+
+    size_t found = 0;
+    double start = BenchNow();
+    for(size_t x = 0; x < rounds; x++)
+    {
+        found += INIHandleAcquire(handle, 0) != NULL;
+        INIHandleRelease(handle, 0);
+    }
+    double elapsed = BenchNow() - start;
+
+    INIHandleFree(handle);
+
+    printf("Handle\n");
+    printf("  Acquire and release %8.1f ns\n", elapsed * 1e9 / rounds);
+    BenchRecord("Handle", "Acquire and release", elapsed * 1e9 / rounds, "ns");
+    return found == rounds ? 0 : -1;
+}
+
+// Compares float formatting and parsing against the C library on random doubles
+static int BenchFloats()
+{
+    const size_t count = 200000;
+    double *values = malloc(count * sizeof(*values));
+    char *strings = malloc(count * INIFloatBufferSize);
+    if(values == NULL || strings == NULL)
+    {
+        free(values);
+        free(strings);
+        return -1;
+    }
+
+    uint64_t state = 88172645463325252u;
+    for(size_t x = 0; x < count; x++)
+    {
+        // Keeps the exponent in a typical range, values still cover the whole significand
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint64_t bits = (state & 0x800FFFFFFFFFFFFFu) | ((uint64_t)(1023 - 40 + state % 80) << 52);
+        memcpy(values + x, &bits, sizeof(*values));
+    }
+
+    char buffer[INIFloatBufferSize];
+    size_t sink = 0;
+
+    double start = BenchNow();
+    for(size_t x = 0; x < count; x++)
+        sink += INIFormatFloat(values[x], strings + x * INIFloatBufferSize);
+    double format = BenchNow() - start;
+
+    start = BenchNow();
+    for(size_t x = 0; x < count; x++)
+        sink += snprintf(buffer, sizeof(buffer), "%.17g", values[x]);
+    double formatLibc = BenchNow() - start;
+
+    size_t mismatches = 0;
+    double parsed, sum = 0;
+
+    start = BenchNow();
+    for(size_t x = 0; x < count; x++)
+    {
+        char *string = strings + x * INIFloatBufferSize;
+        INIParseFloat(string, strlen(string), &parsed);
+        sum += parsed;
+        mismatches += parsed != values[x];
+    }
+    double parse = BenchNow() - start;
+
+    start = BenchNow();
+    for(size_t x = 0; x < count; x++)
+        sum += strtod(strings + x * INIFloatBufferSize, NULL);
+    double parseLibc = BenchNow() - start;
+
+    free(values);
+    free(strings);
+
+    printf("Floats\n");
+    printf("  INIFormatFloat %8.1f ns/op, snprintf %%.17g %8.1f ns/op\n", format * 1e9 / count, formatLibc * 1e9 / count);
+    printf("  INIParseFloat  %8.1f ns/op, strtod        %8.1f ns/op\n", parse * 1e9 / count, parseLibc * 1e9 / count);
+    BenchRecord("Floats", "INIFormatFloat", format * 1e9 / count, "ns");
+    BenchRecord("Floats", "snprintf", formatLibc * 1e9 / count, "ns");
+    BenchRecord("Floats", "INIParseFloat", parse * 1e9 / count, "ns");
+    BenchRecord("Floats", "strtod", parseLibc * 1e9 / count, "ns");
+
+    // Keeps the loops from being optimized away
+    if(sink == 0 || sum != sum)
+        printf("  ");
+
+    if(mismatches != 0)
+    {
+        printf("  %zu values did not round trip\n", mismatches);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Takes the file to write the results to, Bin/Bench.csv by default
+int main(int argc, char **argv)
+{
+    int failed = 0;
+
+    const char *results = argc > 1 ? argv[1] : "Bin/Bench.csv";
+    BenchResults = fopen(results, "w");
+    if(BenchResults == NULL)
+        printf("Cannot write results to %s\n", results);
+    else
+        fprintf(BenchResults, "benchmark,metric,value,unit\n");
+
+    if(BenchParseScaling() != 0)
+        failed = 1;
+    if(BenchRead() != 0)
+        failed = 1;
+    if(BenchStreamChunks() != 0)
+        failed = 1;
+    if(BenchWrite() != 0)
+        failed = 1;
+    if(BenchJournal() != 0)
+        failed = 1;
+    if(BenchBinary() != 0)
+        failed = 1;
+    if(BenchParallel() != 0)
+        failed = 1;
+    if(BenchEvents() != 0)
+        failed = 1;
+    if(BenchLazy() != 0)
+        failed = 1;
+    if(BenchInterning() != 0)
+        failed = 1;
+    if(BenchFind() != 0)
+        failed = 1;
+    if(BenchFreeze() != 0)
+        failed = 1;
+    if(BenchFindValues() != 0)
+        failed = 1;
+    if(BenchOverlay() != 0)
+        failed = 1;
+    if(BenchClone() != 0)
+        failed = 1;
+    if(BenchBind() != 0)
+        failed = 1;
+    if(BenchHandle() != 0)
+        failed = 1;
+    if(BenchFloats() != 0)
+        failed = 1;
+
+    if(BenchResults != NULL)
+        fclose(BenchResults);
+
+    return failed;
+}
@@ -2,6 +2,7 @@
 #define ___INI_ACCESS___
 
 #include <stdio.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "CollectionsPlus.h"
 
@@ -9,7 +10,14 @@ enum INIType
 {
     INITypeInvalid,
     INITypeString,
-    INITypeFloat
+    INITypeFloat,
+    INITypeInt
+};
+
+enum INIFloatConstants
+{
+    // Enough for the longest output of INIFormatFloat, including the terminator
+    INIFloatBufferSize = 32
 };
 
 enum INIStreamStatus
@@ -19,36 +27,99 @@ enum INIStreamStatus
     INIStreamStatusContinue,
     INIStreamStatusSectionHeaderParseFailed,
     INIStreamStatusPairParseFailed,
-    INIStreamStatusInvalidType
+    INIStreamStatusInvalidType,
+    INIStreamStatusStopped
+};
+
+enum INILookupStatus
+{
+    INILookupStatusFound,
+    INILookupStatusMissing,
+    INILookupStatusTypeMismatch,
+    // Set by INIBind for strings that do not fit into their member
+    INILookupStatusTooLong
 };
 
+enum INIJournalSync
+{
+    // Leaves writing the log to disk to the system, INIJournalFlush does it on demand
+    INIJournalSyncNone,
+    // Every change is on disk before it returns
+    INIJournalSyncAlways
+};
+
+enum INIChange
+{
+    INIChangeAdded,
+    INIChangeRemoved,
+    INIChangeModified
+};
+
+typedef struct INI INI;
+typedef struct INIIndex INIIndex;
+typedef struct INIStrings INIStrings;
+typedef struct INIFrozen INIFrozen;
+typedef struct INIShared INIShared;
+typedef struct INIStats INIStats;
+typedef struct INIJournal INIJournal;
+typedef struct INIHandle INIHandle;
+typedef struct INIWatcher INIWatcher;
+typedef struct INIOverlay INIOverlay;
+
 typedef struct INIPair INIPair;
 struct INIPair
 {
     char *Key;
-    void *Value;
+    // Numbers are stored inline, strings are pointed to by Value
+    union
+    {
+        void *Value;
+        int64_t Int;
+        double Float;
+    };
     enum INIType Type; 
+    // Nonzero while a lazily read float is still the text it was read from, which Value points to until INIGetFloat converts it
+    uint32_t RawLength;
     INIPair *NextPair;
 };
 
+// oldPair is NULL for added keys and newPair for removed ones
+typedef void (*INIChangeCallback)(void *context, enum INIChange change, const char *sectionName, INIPair *oldPair, INIPair *newPair);
+
 typedef struct INISection INISection;
 struct INISection
 {
     char *Name;
     INIPair *FirstPair;
+    INIPair *LastPair;
     INISection *NextSection;
+    INI *Owner;
 };
 
-typedef struct INI
+struct INI
 {
     void *Arena;
+    void *Mappings;
+    INIIndex *Index;
+    INIStrings *Strings;
+    INIFrozen *Frozen;
+    // The frozen contents a clone shares with the INI it was made from
+    INIShared *Shared;
+    INIStats *Stats;
+    INIJournal *Journal;
+    int LazyValues;
+    // Goes up whenever sections or pairs are added, removed or moved, so whoever keeps pointers to them can tell when those may be stale
+    uint64_t Version;
 
     INISection *FirstSection;
-} INI;
+    INISection *LastSection;
+};
 
 typedef struct INIStream
 {
     // These must be set
+    // When reading, a line that runs past the end of IOStream is kept until the next call, 
+    // an IOStreamCount of 0 marks the end of the input and parses the last line
     char *IOStream;
     size_t IOStreamCount;
 
@@ -57,46 +128,195 @@ typedef struct INIStream
     INISection *CurrentSection;
     INIPair *CurrentPair;
     size_t LineBufferRead;
+    char *InPlaceBegin;
+    char *InPlaceEnd;
 } INIStream;
 
-const INIStream INIStreamDefault = 
+static const INIStream INIStreamDefault = 
 {
     .IOStream = NULL,
     .IOStreamCount = 0,
     .LineBuffer = ListDefault,
     .CurrentSection = NULL,
     .CurrentPair = NULL,
-    .LineBufferRead = 0
+    .LineBufferRead = 0,
+    .InPlaceBegin = NULL,
+    .InPlaceEnd = NULL
 };
 
-const INI INIDefault = 
+static const INI INIDefault = 
 {
     .Arena = NULL,
-    .FirstSection = NULL
+    .Mappings = NULL,
+    .Index = NULL,
+    .Strings = NULL,
+    .Frozen = NULL,
+    .Shared = NULL,
+    .Stats = NULL,
+    .Journal = NULL,
+    .LazyValues = 0,
+    .Version = 0,
+    .FirstSection = NULL,
+    .LastSection = NULL
+};
+
+// Only builds with INI_STATS defined count anything, in others the counting is left out of the library entirely
+struct INIStats
+{
+    // Lines given to INIStreamRead and their bytes, newlines included
+    uint64_t Lines;
+    uint64_t Bytes;
+    uint64_t SectionsAdded;
+    uint64_t PairsAdded;
+    // Lines that failed to parse, indexed by their INIStreamStatus
+    uint64_t Failures[INIStreamStatusInvalidType + 1];
+    // Finds by name, including the duplicate checks of adds, and the names or index entries they looked at. 
+    // Pairs of frozen sections are not counted, as they are shared with clones
+    uint64_t Lookups;
+    uint64_t Probes;
+    double AverageProbes;
+    // The bytes left over at the end of full blocks are wasted, the rest of the current block and spare blocks are free
+    uint64_t ArenaBlocks;
+    uint64_t ArenaUsed;
+    uint64_t ArenaWasted;
+    uint64_t ArenaFree;
+    // Reading covers whole files including their parsing, which is also counted on its own by INIStreamRead, writing is INIStreamWrite
+    double ReadSeconds;
+    double ParseSeconds;
+    double WriteSeconds;
 };
 
+// Handlers for INIStreamParse and INIParse, any of them may be NULL. Names, keys and values are views into the input 
+// that are only valid during the call, strings without their quotes. Returning nonzero stops the parse
+typedef struct INIHandlers
+{
+    void *Context;
+    int (*Section)(void *context, const char *name, size_t length);
+    int (*Pair)(void *context, const char *key, size_t keyLength, const char *value, size_t valueLength, enum INIType type);
+    // Gets INIStreamStatusSectionHeaderParseFailed or INIStreamStatusPairParseFailed and the whole line
+    int (*Error)(void *context, enum INIStreamStatus status, const char *line, size_t length);
+} INIHandlers;
+
 int INIStreamRead(INI *INI, INIStream *Stream);
+// Reports every line of the stream to the handlers without building an INI, only lines split across chunks are buffered.
+// Returns INIStreamStatusStopped when a handler stopped it, calling it again continues after that line
+int INIStreamParse(INIStream *stream, const INIHandlers *handlers);
 int INIStreamWrite(INI *INI, INIStream *Stream);
 void INIStreamFree(INIStream *Stream);
 
 int INIRead(INI *INI, char *file);
+// Streams the file through INIStreamParse
+int INIParse(char *file, const INIHandlers *handlers);
+// Maps the file and parses it in place, names, keys and strings point into the mapping until INIFree instead of being copied
+int INIReadMapped(INI *INI, char *file);
+// Maps the file like INIReadMapped and parses it on up to the given number of threads, split at section headers. 
+// The result is the same as that of INIRead, small files use fewer threads
+int INIReadParallel(INI *INI, char *file, int threads);
 int INIWrite(INI *INI, char *file);
+// Saves the INI as a binary image that INILoadBinary maps without parsing. The source file is optional, 
+// its modification time, size and hash are recorded so INILoadBinary can tell when the image is stale
+int INISaveBinary(INI *INI, char *file, char *sourceFile);
+// Maps a binary image into an empty INI, names, keys and strings point into the mapping until INIFree. 
+// A missing, corrupt or stale image falls back to parsing the source file with INIRead, in which case 1 is returned instead of 0
+int INILoadBinary(INI *INI, char *file, char *sourceFile);
 void INIFree(INI *INI);
+// Copies the live sections, pairs and values into one block of the size they need and frees all other blocks and mappings, 
+// which leaves out what removed pairs and replaced values took up. Gives the bytes freed, every pointer into the INI is invalid afterwards
+int INICompact(INI *INI, int64_t *reclaimed);
+// Empties the INI but keeps its memory to be reused by the next read, an enabled index stays enabled
+int INIReset(INI *INI);
+// Makes the INI allocate from the buffer until it is full, must be called before anything is added. The buffer is never freed by the INI
+int INIUseBuffer(INI *INI, void *buffer, size_t size);
+
+// Builds a hash index over all sections and pairs of the INI, which is kept up to date by all following adds and removes.
+// Lookups and duplicate checks become O(1) on average, the order of the section and pair lists is unaffected.
+int INIEnableIndex(INI *INI);
+// Starts counting into the statistics of the INI, which are kept by INIReset and freed by INIFree. Fails with ENOTSUP without INI_STATS. 
+// Readers on other threads, such as those of an INIHandle, count with relaxed atomic adds, so no count is lost but each costs an atomic
+int INIEnableStats(INI *INI);
+// Copies the counters and works out the averages and arena usage
+int INIGetStats(INI *INI, INIStats *stats);
+// Makes all sections and pairs with the same name share one copy of it, names already in the INI included. 
+// Kept enabled by INIReset like the index, a frozen INI has its own copies
+int INIEnableInterning(INI *INI);
+// Keeps floats read from then on as their text and converts them on their first INIGetFloat, which saves the conversion 
+// of all values that are never read. Reading a value then writes to its pair, so INIHandlePublish and INIFreeze convert 
+// all of them first, and INIs shared between threads through either are never written to by a read
+int INIEnableLazyValues(INI *INI);
+// Logs changes made through INIAddSection, INIRemoveSection, INISetValue, INIAddValue and INIRemovePair to the file name 
+// with .journal appended, once INIRead read the file. INIRead replays the log on top of the file, so the INI is as it was 
+// left. A log past compactSize bytes is compacted by the next change, 0 leaves that to INIJournalCompact. Kept by INIReset
+int INIEnableJournal(INI *INI, enum INIJournalSync sync, size_t compactSize);
+// Writes the whole INI to a temporary file that replaces the one read once it is on disk, then empties the log
+int INIJournalCompact(INI *INI);
+int INIJournalFlush(INI *INI);
+// Repacks the INI into one block where each section is followed by its pairs and strings, with sorted lookup tables, 
+// keeping the order of the lists, and frees all arena blocks but the first. Afterwards every call that would change the INI 
+// fails with EPERM until INIReset or INIFree
+int INIFreeze(INI *INI);
+// Makes the clone a copy of the INI without changing it, so any number of threads may clone the same INI. A frozen INI and 
+// a clone share their frozen sections, pairs and strings with the clone, a clone of a frozen INI takes constant time and one 
+// of a clone copies what that clone changed. Any other INI is frozen into contents only the clone has, which costs as much as INIFreeze. 
+// Changes copy only the changed frozen section and its pairs, so sections and pairs found before a change may be the shared ones 
+// and have to be looked up again to see it. The shared contents are freed along with the last INI using them
+int INIClone(INI *INI, struct INI *clone);
+
+// A name with its length and hash worked out once, for names that are looked up over and over. It points to the name, which has to outlive it
+typedef struct INIKey
+{
+    const char *Name;
+    size_t Length;
+    uint32_t Hash;
+    // Set for keys made by INIInternKey, whose names are then compared by pointer only
+    const INI *Interned;
+} INIKey;
+
+INIKey INIKeyMake(const char *name);
+// Makes a key from the shared copy of the name, which is added if the INI has none yet. 
+// Such a key only finds names of that INI and is valid until it is frozen, reset or freed
+int INIInternKey(INI *INI, const char *name, INIKey *key);
+// With an index or a frozen INI these skip hashing the name, which leaves one probe and one comparison
+INISection *INIFindSectionByKey(INI *INI, const INIKey *key);
+INIPair *INIFindPairByKey(INISection *section, const INIKey *key);
 
 INISection *INIFindSection(INI *INI, char *sectionName);
+// The section after the given one, NULL after the last. The same as NextSection except in clones, 
+// whose list skips the frozen sections they changed or removed, so they have to be iterated this way
+INISection *ININextSection(INI *INI, INISection *section);
 int INIRemoveSection(INI *INI, INISection *section);
 INISection *INIAddSection(INI *INI, char *sectionName);
 
 INIPair *INIFindPair(INISection *section, char *key);
 int INIFindAndRemovePair(INISection *section, char *key);
+// Deprecated for clones, where a frozen section the clone has not changed yet belongs to the frozen INI and fails with EPERM
 int INIRemovePair(INISection *section, INIPair *pair);
+// Removes the pair from the section of the INI, giving a clone its own copy of a frozen section first
+int INIRemovePairFrom(INI *INI, INISection *section, INIPair *pair);
 
+// The type has to match the pair exactly. Whole numbers such as "timeout = 30" are read as INITypeInt, 
+// INIGetNumber reads them and floats alike
 void *INIGetValue(INIPair *pair, enum INIType type);
 void *INIFindValue(INISection *section, char *key, enum INIType type);
 INIPair *INIAddValue(INI *INI, INISection *section, char *key, enum INIType type, void *value);
+// A string that is no longer than the current one overwrites it in place
 int INISetValue(INI *INI, INIPair *pair, enum INIType type, void *value);
 int INIFindAndSetValue(INI *INI, INISection *section, char *key, enum INIType type, void *value);
 
+typedef struct INILookup
+{
+    // Set by the caller
+    char *Key;
+    enum INIType Type;
+    // Set by INIFindValues, Pair is set for keys of another type as well but Value only for found ones
+    enum INILookupStatus Status;
+    INIPair *Pair;
+    void *Value;
+} INILookup;
+
+// Looks up many keys of a section at once, probing the index for all of them or walking the section once without one. 
+// Missing keys and keys of another type only set the status of their lookup. Returns the number found
+int INIFindValues(INISection *section, INILookup *lookups, size_t count);
+
 char *INIGetString(INIPair *pair);
 char *INIFindString(INISection *section, char *key);
 INIPair *INIAddString(INI *INI, INISection *section, char *key, char *string);
@@ -114,5 +334,94 @@ double *INIFindFloat(INISection *section, char *key);
 INIPair *INIAddFloat(INI *INI, INISection *section, char *key, double number);    
 int INISetFloat(INI *INI, INIPair *pair, double integer);
 int INIFindAndSetFloat(INI* INI, INISection *section, char *key, double integer);
+// Gives INITypeInt and INITypeFloat pairs as a double, like INIBind does for float fields. Fails with EINVAL for other types
+int INIGetNumber(INIPair *pair, double *number);
+int INIFindNumber(INISection *section, char *key, double *number);
+
+// Shares an INI between threads and replaces it while they keep reading. Readers are numbered from 0 to readerCount - 1, 
+// each number may only be used by one thread at a time
+INIHandle *INIHandleCreate(size_t readerCount);
+// There must be no readers left
+void INIHandleFree(INIHandle *handle);
+// Returns the current INI without locking, NULL before the first publish. It stays valid until the reader releases it and must not be changed
+INI *INIHandleAcquire(INIHandle *handle, size_t reader);
+void INIHandleRelease(INIHandle *handle, size_t reader);
+// Makes a malloced INI the current one, the handle owns it from then on. Waits until no reader holds the previous INI and frees it
+int INIHandlePublish(INIHandle *handle, INI *INI);
+// Reads the file into a new INI and publishes it
+int INIHandleLoad(INIHandle *handle, char *file);
+
+// Watches a file and reloads it when its content changes. With a handle every reload is published to it, which then owns the INIs. 
+// Saving the file unchanged only costs hashing it, but every change is parsed in full by a reload and the whole tree is compared 
+// with the previous one to find the changed keys, so it suits files that are edited by hand rather than written often
+INIWatcher *INIWatcherCreate(char *file, INIHandle *handle);
+void INIWatcherFree(INIWatcher *watcher);
+// The INI of the last reload, it is replaced by the next one
+INI *INIWatcherINI(INIWatcher *watcher);
+// Calls the callback for every added, removed or changed key, a NULL section or key matches all of them
+int INIWatcherSubscribe(INIWatcher *watcher, char *section, char *key, INIChangeCallback callback, void *context);
+// Reloads the file if its content changed since the last reload and notifies the subscribers. Returns the number of changed keys
+int INIWatcherCheck(INIWatcher *watcher);
+// Waits up to timeout milliseconds, or forever if it is negative, for the file to be written and then checks it
+int INIWatcherPoll(INIWatcher *watcher, int timeout);
+
+// Stacks INIs so that each one overrides those added before it, without copying any of them. The INIs stay owned by the caller 
+// and may change in between lookups, which are cached per section and key until one of them does. Not for several threads at once
+INIOverlay *INIOverlayCreate(void);
+void INIOverlayFree(INIOverlay *overlay);
+int INIOverlayAdd(INIOverlay *overlay, INI *INI);
+// The pair of the topmost INI that has the key in the section with a value, pairs that failed to parse are passed over as by INIFlatten
+INIPair *INIOverlayFindPair(INIOverlay *overlay, char *sectionName, char *key);
+void *INIOverlayFindValue(INIOverlay *overlay, char *sectionName, char *key, enum INIType type);
+char *INIOverlayFindString(INIOverlay *overlay, char *sectionName, char *key);
+int64_t *INIOverlayFindInt(INIOverlay *overlay, char *sectionName, char *key);
+double *INIOverlayFindFloat(INIOverlay *overlay, char *sectionName, char *key);
+// Copies what the overlay resolves to into an empty INI in one pass from the top INI down, copying each value once. Sections 
+// and keys are in the order they first show up in on the way, pairs that failed to parse are left out. An index on the INI 
+// keeps this linear, as every key is looked up in it
+int INIFlatten(INIOverlay *overlay, INI *INI);
+
+// Describes a struct member that INIBind fills from a key. Strings are copied into char arrays, integers go into int64_t 
+// and floats into double members. Declared with the macros below, which work out the offset and size of the member
+typedef struct INIField
+{
+    const char *Section;
+    const char *Key;
+    enum INIType Type;
+    size_t Offset;
+    size_t Size;
+    // Required fields fail when their key is missing, others get their default
+    int Required;
+    union
+    {
+        const char *String;
+        int64_t Int;
+        double Float;
+    } Default;
+} INIField;
+
+#define INIFieldMember(structType, member, section, key, type, required) \
+    section, key, type, offsetof(structType, member), sizeof(((structType *)0)->member), required
+#define INIFieldString(structType, member, section, key, fallback) \
+    {INIFieldMember(structType, member, section, key, INITypeString, 0), {.String = fallback}}
+#define INIFieldInt(structType, member, section, key, fallback) \
+    {INIFieldMember(structType, member, section, key, INITypeInt, 0), {.Int = fallback}}
+#define INIFieldFloat(structType, member, section, key, fallback) \
+    {INIFieldMember(structType, member, section, key, INITypeFloat, 0), {.Float = fallback}}
+#define INIFieldRequired(structType, member, section, key, type) \
+    {INIFieldMember(structType, member, section, key, type, 1), {.Int = 0}}
+
+// Fills the members of the target the fields describe, looking up each run of fields of the same section at once. 
+// Integers also fill float members. Statuses is NULL or has room for one per field, a missing field that is not required 
+// gets its default and still counts as filled. Returns the number of fields that could not be filled
+int INIBind(INI *INI, const INIField *fields, size_t count, void *target, enum INILookupStatus *statuses);
+// Fills the members like INIBind straight from the lines of the file, without building an INI. A key counts the first time 
+// it shows up, the file is only read until every key was seen
+int INIBindFile(char *file, const INIField *fields, size_t count, void *target, enum INILookupStatus *statuses);
+
+// Writes the shortest decimal that reads back as exactly the same double, regardless of the locale. Returns the length written
+size_t INIFormatFloat(double value, char *buffer);
+// Parses a decimal float with correct rounding, regardless of the locale. Returns the number of characters consumed, 0 if there is no number
+size_t INIParseFloat(const char *string, size_t length, double *value);
 
 #endif
\ No newline at end of file
@@ -1,676 +1,4092 @@
 #include "INIAccess.h"
+#include "INIInternal.h"
 #include "Assert.h"
 #include <stdlib.h>
+#include <stddef.h>
+#include <inttypes.h>
 #include <Try.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <sys/stat.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 const char *PairTypeMismatchMessage = "Type mismatch detected while reading data from INI pair";
+static const char *FrozenMessage = "Cannot change a frozen INI";
+static const char *NotInINIMessage = "The pair is not in the INI";
 
 enum Constants
 {
     ArenaBaseSize = 1024,
+    ArenaMaxScaledSize = 1 << 24,
     ArenaScaleMultiplier = 2,
-    ArenaScaleDivisor = 1
+    ArenaScaleDivisor = 1,
+    ArenaAlignment = _Alignof(max_align_t),
+
+    FrozenLinearSearchMax = 8,
+    FrozenAlignment = _Alignof(INIPair) > _Alignof(INISection) ? _Alignof(INIPair) : _Alignof(INISection),
+
+    ReadBufferSize = 16384,
+    ParallelMinChunkSize = 1 << 16,
+    WriteBufferSize = 1 << 18,
+    LinePieceCount = 6,
+
+    BinaryVersion = 1,
+    BinaryByteOrder = 0x0102,
+    BinaryAlignment = _Alignof(max_align_t),
+
+    IndexBaseCapacity = 16,
+    IndexMaxLoadMultiplier = 3,
+    IndexMaxLoadDivisor = 4,
+
+    LookupBatchSize = 16,
+    LookupStackSlots = 256,
+
+    JournalVersion = 1
 };
 
+// Counting only happens in builds with INI_STATS, otherwise the statistics are left out entirely. 
+// Readers on several threads count into the same INI, so the counters are added to atomically, without ordering
+#ifdef INI_STATS
+#define INIStatsAdd(stats, field, count) do { INIStats *countedStats = (stats); if(countedStats != NULL) \
+    atomic_fetch_add_explicit((_Atomic(uint64_t) *)&countedStats->field, (count), memory_order_relaxed); } while(0)
+#define INIStatsStart(start) double start = INIStatsNow()
+#define INIStatsStop(stats, field, start) do { INIStats *countedStats = (stats); if(countedStats != NULL) \
+    INIStatsAddSeconds(&countedStats->field, INIStatsNow() - (start)); } while(0)
+
+static double INIStatsNow()
+{
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+#else
+#define INIStatsAdd(stats, field, count) ((void)(stats))
+#define INIStatsStart(start) ((void)0)
+#define INIStatsStop(stats, field, start) ((void)(stats))
+#endif
+
+// Blocks are chained from oldest to newest, INI->Arena is the block currently bumped from. 
+// Blocks after it are empty and were kept by INIReset for reuse
 typedef struct INIArena INIArena; 
 struct INIArena
 {
     INIArena *PreviousArena;
+    INIArena *NextArena;
     size_t Size;
     size_t Used;
+    int External;
 } ;
 
+typedef struct INIIndexEntry
+{
+    uint32_t Hash;
+    const INISection *Scope;
+    void *Element;
+} INIIndexEntry;
+
+// Open addressing table with linear probing, elements are INISections, INIPairs or interned names, which all start with their name.
+typedef struct INITable
+{
+    INIIndexEntry *Entries;
+    size_t Capacity;
+    size_t Count;
+    size_t Used;
+} INITable;
+
+struct INIIndex
+{
+    INITable Sections;
+    INITable Pairs;
+};
+
+// Elements are arena slots holding the shared copy of a name
+struct INIStrings
+{
+    INITable Names;
+};
+
+// Sorted by hash, so lookups are a binary search over small entries followed by a single name comparison
+typedef struct INIFrozenEntry
+{
+    uint32_t Hash;
+    uint32_t Index;
+} INIFrozenEntry;
+
+// A frozen INI is one block of sections, each directly followed by its pairs, the sorted entries of its pairs if it has 
+// more than FrozenLinearSearchMax of them, and its strings. Iterating is a linear scan and a lookup touches one stretch of memory.
+// Section entries index the block in steps of FrozenAlignment and are in Eytzinger order starting at 1, 
+// so the first levels of every search share a few cache lines
+// The block is shared with the clones made of the INI and freed along with the last INI that uses it
+struct INIFrozen
+{
+    char *Block;
+    size_t Size;
+    INIFrozenEntry *SectionEntries;
+    // Offsets of the sections in list order, which is their order in the block
+    uint32_t *SectionOffsets;
+    size_t SectionCount;
+    atomic_size_t References;
+    // Owns the frozen sections in place of the INI, so they stay valid for clones once that INI is freed
+    INI Owner;
+};
+
+// What a clone shares with the INI it was made from. Its list is the frozen list, where the frozen sections it changed are 
+// replaced by nodes of its own found through Copies, followed by the sections added to it. Changes only cost their own copies
+struct INIShared
+{
+    INIFrozen *Frozen;
+    // Keyed by the frozen section, a copy without an owner marks a removed one
+    INITable Copies;
+    INISection *FirstAdded;
+    INISection *LastAdded;
+};
+
+// Files mapped by INIReadMapped and INILoadBinary, kept in the arena until INIFree
+typedef struct INIMapping INIMapping;
+struct INIMapping
+{
+    INIMapping *PreviousMapping;
+    void *Data;
+    size_t Size;
+};
+
+// Starts a binary image. Sections and pairs are stored as native INISection and INIPair records, 
+// in list order, with offsets from the start of the image in place of pointers, 0 stands for NULL
+typedef struct INIBinaryHeader
+{
+    char Magic[8];
+    uint32_t Version;
+    uint16_t ByteOrder;
+    uint16_t PointerSize;
+    uint32_t SectionSize;
+    uint32_t PairSize;
+
+    uint64_t SectionCount;
+    uint64_t PairCount;
+    uint64_t SectionsOffset;
+    uint64_t PairsOffset;
+    uint64_t StringsOffset;
+    uint64_t Size;
+
+    int64_t SourceTime;
+    uint64_t SourceSize;
+    uint64_t SourceHash;
+
+    // Covers everything after the header
+    uint64_t Checksum;
+} INIBinaryHeader;
+
+static const char INIBinaryMagic[8] = "INIBIN\r\n";
+
+// Starts the log of a journaled INI. Every record after it is an INIJournalRecord followed by the kind and type of the change 
+// as one byte each, the section name, the key and the value. Names and strings end in a NUL, numbers are native 8 byte values
+typedef struct INIJournalHeader
+{
+    char Magic[8];
+    uint32_t Version;
+    uint16_t ByteOrder;
+    uint16_t Padding;
+} INIJournalHeader;
+
+// The checksum covers the Size bytes after it, the log ends at the first record that is cut short or does not match
+typedef struct INIJournalRecord
+{
+    uint32_t Size;
+    uint32_t Checksum;
+} INIJournalRecord;
+
+enum INIJournalKind
+{
+    INIJournalAddSection,
+    INIJournalRemoveSection,
+    INIJournalSetValue,
+    INIJournalRemovePair
+};
+
+struct INIJournal
+{
+    enum INIJournalSync Sync;
+    size_t CompactSize;
+    char *File;
+    char *LogFile;
+    // Open from the INIRead of File on
+    FILE *Log;
+    size_t LogSize;
+    int Replaying;
+    // The section of every pair, as changes to a pair are logged with the names of both
+    INITable Pairs;
+};
+
+static const char INIJournalMagic[8] = "INILOG\r\n";
+static const char *NoJournalMessage = "The INI has no open journal";
+
+static char INIIndexTombstone;
+
 TypedefList(char, ListChar);
 
-static char *StripLeadingWhitespace(char *string)
+static const char *StripLeadingWhitespace(const char *string, const char *end)
 {
-    while(*string == ' ' && *string != '\0')
+    while(string < end && *string == ' ')
         string++;
 
     return string;
 }
 
-static void StripEndingWhitespace(char *string)
+static const char *StripEndingWhitespace(const char *string, const char *end)
 {
-    while(*string != '\0')
-        string++;
+    while(end > string && end[-1] == ' ')
+        end--;
 
-    string--;
-
-    while(*string == ' ')
-    {
-        *string = '\0';
-        string--;
-    }
+    return end;
 }
 
-static void *INIAllocate(INI *INI, size_t size)
+// Compares a stored, null terminated name against a name that is only delimited by its length
+static int ININameEquals(const char *storedName, const char *name, size_t length)
 {
-    INIArena *arena = INI->Arena;
-
-    if(arena != NULL && arena->Size - arena->Used <= size)
-    {
-        arena->Used += size;
-        return (char *)arena + size;
-    }
+    return (storedName == name || strncmp(storedName, name, length) == 0) && storedName[length] == '\0';
+}
 
-    size_t nextSize = arena == NULL ? ArenaBaseSize : arena->Size;
-    while(nextSize < size)
-        nextSize = (nextSize * ArenaScaleMultiplier) / ArenaScaleDivisor;
+static size_t INIAlign(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
 
-    INIArena *newArena = malloc(nextSize);
-    Assert(newArena != NULL, errno, NULL);
+static size_t INIArenaHeaderSize()
+{
+    return INIAlign(sizeof(INIArena), ArenaAlignment);
+}
 
-    newArena->Size = nextSize;
-    newArena->Used = sizeof(*newArena) + size;
+static void INIArenaInsertAfter(INIArena *arena, INIArena *newArena)
+{
     newArena->PreviousArena = arena;
+    newArena->NextArena = arena == NULL ? NULL : arena->NextArena;
 
-    INI->Arena = newArena;
-
-    return (char *)newArena + sizeof(*newArena);
+    if(newArena->NextArena != NULL)
+        newArena->NextArena->PreviousArena = newArena;
+    if(arena != NULL)
+        arena->NextArena = newArena;
 }
 
-INISection *INIFindSection(INI *INI, char *sectionName)
+static INIArena *INIFirstArena(INI *INI)
 {
-    Assert(INI, EINVAL, NULL);
-    Assert(sectionName, EINVAL, NULL);
+    INIArena *arena = INI->Arena;
+    while(arena != NULL && arena->PreviousArena != NULL)
+        arena = arena->PreviousArena;
 
-    for(INISection *section = INI->FirstSection; section != NULL; section = section->NextSection)
-    {
-        if(strcmp(section->Name, sectionName) == 0)
-            return section;
-    }
-    
-    return NULL;
+    return arena;
 }
 
-int INIRemoveSection(INI *INI, INISection *section)
+// Alignment may not exceed ArenaAlignment, which every block starts at
+static void *INIAllocateAligned(INI *INI, size_t size, size_t alignment)
 {
-    Assert(INI, EINVAL, -1);
-    Assert(section, EINVAL, -1);
+    INIArena *arena = INI->Arena;
 
-    if(INI->FirstSection == section)
+    if(arena != NULL)
     {
-        INI->FirstSection = section->NextSection;
-        return 0;
+        size_t offset = INIAlign(arena->Used, alignment);
+        if(offset <= arena->Size && arena->Size - offset >= size)
+        {
+            arena->Used = offset + size;
+            return (char *)arena + offset;
+        }
     }
 
-    for(INISection *iteratingSection = INI->FirstSection; iteratingSection != NULL; iteratingSection = iteratingSection->NextSection)
+    size_t headerSize = INIArenaHeaderSize();
+    INIArena *nextArena = NULL;
+
+    for(INIArena *spareArena = arena == NULL ? NULL : arena->NextArena; spareArena != NULL; spareArena = spareArena->NextArena)
     {
-        if(iteratingSection->NextSection == section)    
+        if(spareArena->Size - headerSize >= size)
         {
-            iteratingSection->NextSection = section->NextSection;
-            return 0;
+            nextArena = spareArena;
+            break;
         }
     }
 
-    return 0;
-}
-
-static void *INIAddLinkedListElement(INI *INI, void **firstElement, size_t elementSize, size_t nextElementOffset)
-{
-    Assert(INI, EINVAL, NULL);
-    Assert(firstElement, EINVAL, NULL);
-    Assert(nextElementOffset < elementSize, EINVAL, NULL);
+    if(nextArena != NULL)
+    {
+        // Moves the spare block directly after the current one, so all blocks past the current one stay empty
+        nextArena->PreviousArena->NextArena = nextArena->NextArena;
+        if(nextArena->NextArena != NULL)
+            nextArena->NextArena->PreviousArena = nextArena->PreviousArena;
+    }
+    else
+    {
+        size_t nextSize = arena == NULL ? ArenaBaseSize : (arena->Size * ArenaScaleMultiplier) / ArenaScaleDivisor;
+        if(nextSize > ArenaMaxScaledSize)
+            nextSize = ArenaMaxScaledSize;
+        if(nextSize < headerSize + size)
+            nextSize = headerSize + size;
 
-    void *newElement;
-    TryNotNull(newElement = INIAllocate(INI, elementSize), NULL);
-    *(void **)((char *)newElement + nextElementOffset) = NULL;
+        nextArena = malloc(nextSize);
+        Assert(nextArena != NULL, errno, NULL);
 
-    void *element = *firstElement;
-    while(element != NULL && *(void **)((char *)element + nextElementOffset) != NULL)
-        element = *(void **)((char *)element + nextElementOffset);
+        nextArena->Size = nextSize;
+        nextArena->External = 0;
+    }
 
-    if(element == NULL)
-        *firstElement = newElement;
-    else
-        *(void **)((char *)element + nextElementOffset) = newElement;
+    INIArenaInsertAfter(arena, nextArena);
+    nextArena->Used = headerSize + size;
+    INI->Arena = nextArena;
 
-    return newElement;
+    return (char *)nextArena + headerSize;
 }
 
-INISection *INIAddSection(INI *INI, char *sectionName)
+static void *INIAllocate(INI *INI, size_t size)
 {
-    Assert(INI, EINVAL, NULL);
-    Assert(sectionName, EINVAL, NULL);
-    AssertMsg(INIFindSection(INI, sectionName) == NULL, EINVAL, NULL, "Cannot add a section with a name that is already in use by another section");
-
-    char *storedSectionName;
-    TryNotNull(storedSectionName = INIAllocate(INI, strlen(sectionName) + 1), NULL);
-    strcpy(storedSectionName, sectionName);
-
-    INISection *newSection;
-    TryNotNull(newSection = INIAddLinkedListElement(INI, (void **)&INI->FirstSection, sizeof(*newSection), offsetof(INISection, NextSection)), NULL);
-    newSection->Name = storedSectionName;
-    newSection->FirstPair = NULL;
-
-    return newSection;
+    return INIAllocateAligned(INI, size, ArenaAlignment);
 }
 
-static INIPair *INIAddPair(INI *INI, INISection *section, char *key)
+int INIUseBuffer(INI *INI, void *buffer, size_t size)
 {
-    Assert(INI, EINVAL, NULL);
-    Assert(section, EINVAL, NULL);
-    Assert(key, EINVAL, NULL);
-    AssertMsg(INIFindPair(section, key) == NULL, EINVAL, NULL, "Cannot add a pair with a key that is already in use by another pair");
+    Assert(INI, EINVAL, -1);
+    Assert(buffer, EINVAL, -1);
+    AssertMsg(INI->Arena == NULL, EINVAL, -1, "A buffer can only be given to an INI that has not allocated anything yet");
 
-    char *storedKeyName;
-    TryNotNull(storedKeyName = INIAllocate(INI, strlen(key) + 1), NULL);
-    strcpy(storedKeyName, key);
+    size_t padding = INIAlign((uintptr_t)buffer, ArenaAlignment) - (uintptr_t)buffer;
+    AssertMsg(size >= padding + INIArenaHeaderSize(), EINVAL, -1, "Buffer is too small to hold an arena");
 
-    INIPair *newPair;
-    TryNotNull(newPair = INIAddLinkedListElement(INI, (void **)&section->FirstPair, sizeof(*newPair), offsetof(INIPair, NextPair)), NULL);
-    newPair->Key = storedKeyName;
-    newPair->Value = NULL;
-    newPair->Type = INITypeInvalid;
+    INIArena *arena = (INIArena *)((char *)buffer + padding);
+    arena->PreviousArena = NULL;
+    arena->NextArena = NULL;
+    arena->Size = size - padding;
+    arena->Used = INIArenaHeaderSize();
+    arena->External = 1;
 
-    return newPair;
+    INI->Arena = arena;
+    return 0;
 }
 
-INIPair *INIFindPair(INISection *section, char *key)
+uint32_t INIHash(const char *string, size_t length)
 {
-    Assert(section, EINVAL, NULL);
-    Assert(key, EINVAL, NULL);
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for(size_t x = 0; x < length; x++)
+        hash = (hash ^ (unsigned char)string[x]) * 16777619u;
 
-    for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
-    {
-        if(strcmp(pair->Key, key) == 0)
-            return pair;
-    }
+    return hash;
+}
 
-    return NULL;
+static uint32_t INIHashScoped(uint32_t hash, const void *scope)
+{
+    uint64_t mixed = ((uint64_t)(uintptr_t)scope ^ hash) * 0x9E3779B97F4A7C15u;
+    return (uint32_t)(mixed >> 32) ^ (uint32_t)mixed;
 }
 
-int INIRemovePair(INISection *section, INIPair *pair)
+// Lookups pass the statistics to count their probes in
+static INIIndexEntry *INITableFind(INITable *table, uint32_t hash, const INISection *scope, const char *name, size_t length, INIStats *stats)
 {
-    Assert(section, EINVAL, -1);
-    Assert(pair, EINVAL, -1);
+    if(table->Capacity == 0)
+        return NULL;
 
-    if(section->FirstPair == pair)
+    size_t mask = table->Capacity - 1;
+    for(size_t x = hash & mask;; x = (x + 1) & mask)
     {
-        section->FirstPair = pair->NextPair;
-        return 0;
-    }
+        INIIndexEntry *entry = table->Entries + x;
+        INIStatsAdd(stats, Probes, 1);
 
-    for(INIPair *iterPair = section->FirstPair; iterPair != NULL; iterPair = iterPair->NextPair)
-    {
-        if(iterPair->NextPair == pair)
-        {
-            iterPair->NextPair = pair->NextPair;
-            return 0;
-        }
-    }
+        if(entry->Element == NULL)
+            return NULL;
 
-    return 0;
+        if(entry->Element != &INIIndexTombstone && entry->Hash == hash && entry->Scope == scope && ININameEquals(*(char **)entry->Element, name, length))
+            return entry;
+    }
 }
 
-int INIFindAndRemovePair(INISection *section, char *key)
+static INIIndexEntry *INITableFreeSlot(INIIndexEntry *entries, size_t capacity, uint32_t hash)
 {
-    INIPair *pair;
-    TryNotNull(pair = INIFindPair(section, key), -1);
-    Try(INIRemovePair(section, pair), -1);
+    size_t mask = capacity - 1;
+    size_t x = hash & mask;
+    while(entries[x].Element != NULL && entries[x].Element != &INIIndexTombstone)
+        x = (x + 1) & mask;
 
-    return 0;
+    return entries + x;
 }
 
-void *INIGetValue(INIPair *pair, enum INIType type)
+static size_t INITableCapacity(size_t count)
 {
-    Assert(pair, EINVAL, NULL);
-    AssertMsg(pair->Type == type, EINVAL, NULL, PairTypeMismatchMessage);
-    return pair->Value;
-}
+    size_t capacity = IndexBaseCapacity;
+    while(count * 2 > capacity)
+        capacity *= 2;
 
-void *INIFindValue(INISection *section, char *key, enum INIType type)
-{
-    INIPair *pair = INIFindPair(section, key);
-    return pair ? INIGetValue(pair, type) : NULL;
+    return capacity;
 }
 
-INIPair *INIAddValue(INI *INI, INISection *section, char *key, enum INIType type, void *value)
+// Makes room for the given number of additional entries with a single rehash
+static int INITableReserve(INI *INI, INITable *table, size_t count)
 {
-    // Callees have asserts
-
-    INIPair *pair;
-    TryNotNull(pair = INIAddPair(INI, section, key), NULL);
-    Try(INISetValue(INI, pair, type, value), NULL);
-
-    return pair;
-}
+    if((table->Used + count) * IndexMaxLoadDivisor <= table->Capacity * IndexMaxLoadMultiplier)
+        return 0;
 
-int INISetValue(INI *INI, INIPair *pair, enum INIType type, void *value)
-{
-    Assert(pair, EINVAL, -1);
-    Assert(value, EINVAL, -1);
+    // Rehashing also drops tombstones, so the table only grows when it is mostly live entries
+    size_t newCapacity = INITableCapacity(table->Count + count);
 
-    void *storedValue;
+    INIIndexEntry *newEntries;
+    TryNotNull(newEntries = INIAllocate(INI, newCapacity * sizeof(*newEntries)), -1);
+    memset(newEntries, 0, newCapacity * sizeof(*newEntries));
 
-    switch(type)
+    for(size_t x = 0; x < table->Capacity; x++)
     {
-        case INITypeString:
-        {
-            // Could optimize to not allocate extra for smaller strings
-            TryNotNull(storedValue = INIAllocate(INI, strlen((char *)value) + 1), -1);
-            strcpy(storedValue, value);
-            break;
-        }
-        case INITypeFloat:
-        {
-            if(pair->Type != INITypeFloat)
-                TryNotNull(storedValue = INIAllocate(INI, sizeof(double)), -1);
-            else
-                storedValue = pair->Value;
-
-            *(double *)storedValue = *(double *)value;
-            break;
-        }
-        default:
-            Throw(EINVAL, -1, "Invalid INIType detected while setting value");
+        INIIndexEntry *entry = table->Entries + x;
+        if(entry->Element != NULL && entry->Element != &INIIndexTombstone)
+            *INITableFreeSlot(newEntries, newCapacity, entry->Hash) = *entry;
     }
 
-    pair->Value = storedValue;
-    pair->Type = type;
+    table->Entries = newEntries;
+    table->Capacity = newCapacity;
+    table->Used = table->Count;
 
     return 0;
 }
 
-int INIFindAndSetValue(INI *INI, INISection *section, char *key, enum INIType type, void *value)
+static int INITableInsert(INI *INI, INITable *table, uint32_t hash, const INISection *scope, void *element)
 {
-    // Callees have asserts
+    Try(INITableReserve(INI, table, 1), -1);
 
-    INIPair *pair;
-    TryNotNull(pair = INIFindPair(section, key), -1);
-    Try(INISetValue(INI, pair, type, value), -1);
+    INIIndexEntry *slot = INITableFreeSlot(table->Entries, table->Capacity, hash);
+    if(slot->Element == NULL)
+        table->Used++;
+
+    *slot = (INIIndexEntry){.Hash = hash, .Scope = scope, .Element = element};
+    table->Count++;
 
     return 0;
 }
 
-// Type safe functions for convenience
+static INIIndexEntry *INITableFindElement(INITable *table, uint32_t hash, const void *element)
+{
+    if(table->Capacity == 0)
+        return NULL;
 
-char *INIGetString(INIPair *pair)
+    size_t mask = table->Capacity - 1;
+    for(size_t x = hash & mask; table->Entries[x].Element != NULL; x = (x + 1) & mask)
+    {
+        if(table->Entries[x].Element == element)
+            return table->Entries + x;
+    }
+
+    return NULL;
+}
+
+static void INITableRemove(INITable *table, uint32_t hash, void *element)
 {
-    return INIGetValue(pair, INITypeString);
+    INIIndexEntry *entry = INITableFindElement(table, hash, element);
+    if(entry != NULL)
+    {
+        entry->Element = &INIIndexTombstone;
+        table->Count--;
+    }
 }
 
-char *INIFindString(INISection *section, char *key)
+static int INIIndexAddSection(INI *INI, INISection *section)
 {
-    return INIFindValue(section, key, INITypeString);
+    uint32_t hash = INIHash(section->Name, strlen(section->Name));
+    return INITableInsert(INI, &INI->Index->Sections, hash, NULL, section);
 }
 
-INIPair *INIAddString(INI *INI, INISection *section, char *key, char *string)
+static int INIIndexAddPair(INI *INI, INISection *section, INIPair *pair)
 {
-    return INIAddValue(INI, section, key, INITypeString, string);
+    uint32_t hash = INIHashScoped(INIHash(pair->Key, strlen(pair->Key)), section);
+    return INITableInsert(INI, &INI->Index->Pairs, hash, section, pair);
 }
 
-int INISetString(INI *INI, INIPair *pair, char *string)
+// Pairs are tracked by their address
+static int INIJournalTrack(INI *INI, INISection *section, INIPair *pair)
 {
-    return INISetValue(INI, pair, INITypeString, string);
+    return INITableInsert(INI, &INI->Journal->Pairs, INIHashScoped(0, pair), section, pair);
 }
 
-int INIFindAndSetString(INI *INI, INISection *section, char *key, char *string)
+static void INIJournalUntrack(INI *INI, INIPair *pair)
 {
-    return INIFindAndSetValue(INI, section, key, INITypeString, string);
+    INITableRemove(&INI->Journal->Pairs, INIHashScoped(0, pair), pair);
 }
 
-double *INIGetFloat(INIPair *pair)
+static INISection *INIJournalSection(INI *INI, INIPair *pair)
 {
-    return INIGetValue(pair, INITypeFloat);
+    INIIndexEntry *entry = INITableFindElement(&INI->Journal->Pairs, INIHashScoped(0, pair), pair);
+    return entry != NULL ? (INISection *)entry->Scope : NULL;
 }
 
-double *INIFindFloat(INISection *section, char *key)
+// Changes are only logged once INIRead opened the log, and not while it replays it
+static int INIJournaling(INI *INI)
 {
-    return INIFindValue(section, key, INITypeFloat);
+    return INI != NULL && INI->Journal != NULL && INI->Journal->Log != NULL && !INI->Journal->Replaying;
 }
 
-INIPair *INIAddFloat(INI *INI, INISection *section, char *key, double number)
+static void INIJournalClose(INIJournal *journal)
 {
-    return INIAddValue(INI, section, key, INITypeFloat, &number);
+    if(journal->Log != NULL)
+        fclose(journal->Log);
+    journal->Log = NULL;
 }
 
-int INISetFloat(INI *INI, INIPair *pair, double number)
+static int INIJournalSyncFile(FILE *file)
 {
-    return INISetValue(INI, pair, INITypeFloat, &number);
+    Assert(fflush(file) == 0, errno, -1);
+#ifdef _WIN32
+    Assert(_commit(_fileno(file)) == 0, errno, -1);
+#else
+    Assert(fsync(fileno(file)) == 0, errno, -1);
+#endif
+
+    return 0;
 }
 
-int INIFindAndSetFloat(INI* INI, INISection *section, char *key, double number)
+// A log that grew past its limit is compacted before the next record, when the INI holds every change logged so far. 
+// Failing to compact only leaves the log longer, so the change is logged anyway
+static int INIJournalChange(INI *INI, enum INIJournalKind kind, const char *sectionName, const char *key, enum INIType type, const void *value)
 {
-    return INIFindAndSetValue(INI, section, key, INITypeFloat, &number);
+    INIJournal *journal = INI->Journal;
+    if(journal->CompactSize != 0 && journal->LogSize > journal->CompactSize)
+        INIJournalCompact(INI);
+
+    size_t sectionSize = strlen(sectionName) + 1, keySize = key != NULL ? strlen(key) + 1 : 0, valueSize = 0;
+    if(value != NULL)
+        valueSize = type == INITypeString ? strlen(value) + 1 : sizeof(int64_t);
+
+    size_t size = sizeof(INIJournalRecord) + 2 + sectionSize + keySize + valueSize;
+    char *record;
+    TryNotNull(record = malloc(size), -1);
+
+    char *body = record + sizeof(INIJournalRecord), *next = body + 2;
+    body[0] = (char)kind;
+    body[1] = (char)type;
+    memcpy(next, sectionName, sectionSize);
+    next += sectionSize;
+    if(keySize != 0)
+        memcpy(next, key, keySize);
+    next += keySize;
+    if(valueSize != 0)
+        memcpy(next, value, valueSize);
+
+    INIJournalRecord header = {(uint32_t)(size - sizeof(INIJournalRecord)), 0};
+    header.Checksum = INIHash(body, header.Size);
+    memcpy(record, &header, sizeof(header));
+
+    size_t written = fwrite(record, 1, size, journal->Log);
+    free(record);
+    AssertMsg(written == size && fflush(journal->Log) == 0, EIO, -1, "Cannot append to the journal");
+
+    if(journal->Sync == INIJournalSyncAlways)
+        Try(INIJournalSyncFile(journal->Log), -1);
+
+    journal->LogSize += size;
+    return 0;
 }
 
-int INIStreamRead(INI *INI, INIStream *stream)
+int INIEnableIndex(INI *INI)
 {
-    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
-    Assert(stream, EINVAL, INIStreamStatusFatalFailure);
+    Assert(INI, EINVAL, -1);
 
-    ListChar *lineBuffer = (ListChar *)&stream->LineBuffer;
+    // Frozen INIs have their own lookup tables
+    if(INI->Index != NULL || INI->Frozen != NULL)
+        return 0;
 
-    while(1)
+    INIIndex *index;
+    TryNotNull(index = INIAllocate(INI, sizeof(*index)), -1);
+    memset(index, 0, sizeof(*index));
+    INI->Index = index;
+
+    for(INISection *section = INI->FirstSection; section != NULL; section = section->NextSection)
     {
-        if(lineBuffer->Count > 0 && (lineBuffer->V[lineBuffer->Count - 1] == '\n' || stream->IOStreamCount == 0))
-        {
-            const char terminator = '\0';
-            Try(ListAdd(lineBuffer, &terminator), INIStreamStatusFatalFailure);
-            char *line = StripLeadingWhitespace(lineBuffer->V);
-            
-            if(*line == '[')
-            {
-                char *sectionName = line + 1;
-                while(*line != ']')
-                {
-                    if(*line == '\0' || *line == '\n')
-                        goto FailSection;
+        Try(INIIndexAddSection(INI, section), -1, INI->Index = NULL;);
 
-                    line++;
-                }
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            Try(INIIndexAddPair(INI, section, pair), -1, INI->Index = NULL;);
+    }
 
-                *line = '\0';
+    return 0;
+}
 
-                if(*StripLeadingWhitespace(line + 1) != '\n')
-                    goto FailSection;
+static const INIFrozenEntry *INIFrozenLowerBound(const INIFrozenEntry *entries, size_t count, uint32_t hash)
+{
+    if(count == 0)
+        return entries;
 
-                TryNotNull(INIAddSection(INI, sectionName), INIStreamStatusFatalFailure, 
-                    if(errno == EINVAL)
-                        goto FailSection;
-                );
-                ListClear(lineBuffer);
-                continue;
-                    
-                FailSection:
-                ListClear(lineBuffer);
-                Throw(EINVAL, INIStreamStatusSectionHeaderParseFailed, "INI stream failed to parse section header");
+    // Branchless, the loop runs log2(count) times whatever the hash is
+    while(count > 1)
+    {
+        size_t half = count / 2;
+        entries = entries[half].Hash < hash ? entries + half : entries;
+        count -= half;
+    }
+
+    return entries + (entries->Hash < hash);
+}
+
+static void *INIFrozenFind(const INIFrozenEntry *entries, size_t count, void *records, size_t recordSize, const char *name, size_t length, uint32_t hash, INIStats *stats)
+{
+    const INIFrozenEntry *end = entries + count;
+
+    for(const INIFrozenEntry *entry = INIFrozenLowerBound(entries, count, hash); entry < end && entry->Hash == hash; entry++)
+    {
+        INIStatsAdd(stats, Probes, 1);
+        void *record = (char *)records + (size_t)entry->Index * recordSize;
+        if(ININameEquals(*(char **)record, name, length))
+            return record;
+    }
+
+    return NULL;
+}
+
+static INISection *INIFrozenFindSection(INIFrozen *frozen, const char *sectionName, size_t length, uint32_t hash, INIStats *stats)
+{
+    const INIFrozenEntry *entries = frozen->SectionEntries;
+    size_t count = frozen->SectionCount;
+
+    // Descends to the first entry not below the hash, prefetching the 16 entries four levels down
+    size_t position = 1;
+    while(position <= count)
+    {
+#ifdef __GNUC__
+        __builtin_prefetch(entries + position * 16);
+#endif
+        position = 2 * position + (entries[position].Hash < hash);
+    }
+
+    while(position & 1)
+        position >>= 1;
+    position >>= 1;
+
+    while(position != 0 && entries[position].Hash == hash)
+    {
+        INIStatsAdd(stats, Probes, 1);
+        INISection *section = (INISection *)(frozen->Block + (size_t)entries[position].Index * FrozenAlignment);
+        if(ININameEquals(section->Name, sectionName, length))
+            return section;
+
+        // Moves on to the next entry in sorted order
+        if(2 * position + 1 <= count)
+        {
+            position = 2 * position + 1;
+            while(2 * position <= count)
+                position *= 2;
+        }
+        else
+        {
+            while(position & 1)
+                position >>= 1;
+            position >>= 1;
+        }
+    }
+
+    return NULL;
+}
+
+static void INIFrozenRelease(INIFrozen *frozen)
+{
+    if(frozen != NULL && atomic_fetch_sub(&frozen->References, 1) == 1)
+        free(frozen);
+}
+
+static int INIFrozenContains(const INIFrozen *frozen, const void *pointer)
+{
+    return frozen != NULL && (const char *)pointer >= frozen->Block && (const char *)pointer < frozen->Block + frozen->Size;
+}
+
+static void INISharedRelease(INI *INI)
+{
+    if(INI->Shared == NULL)
+        return;
+
+    INIFrozenRelease(INI->Shared->Frozen);
+    free(INI->Shared);
+    INI->Shared = NULL;
+}
+
+// Whether the pointer is into the frozen contents the INI is a clone of, which are never written to
+static int INIIsShared(const INI *INI, const void *pointer)
+{
+    return INI != NULL && INI->Shared != NULL && INIFrozenContains(INI->Shared->Frozen, pointer);
+}
+
+// The place in the list of the section a pointer into the block is in, as each section is followed by its pairs
+static size_t INIFrozenOrdinal(const INIFrozen *frozen, const void *pointer)
+{
+    uint32_t offset = (uint32_t)(((const char *)pointer - frozen->Block) / FrozenAlignment);
+    size_t low = 0, high = frozen->SectionCount;
+    while(high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+        if(frozen->SectionOffsets[middle] <= offset)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+static INISection *INIFrozenSection(const INIFrozen *frozen, size_t ordinal)
+{
+    return (INISection *)(frozen->Block + (size_t)frozen->SectionOffsets[ordinal] * FrozenAlignment);
+}
+
+static INISection *INIFrozenSectionOf(const INIFrozen *frozen, const void *pointer)
+{
+    return INIFrozenSection(frozen, INIFrozenOrdinal(frozen, pointer));
+}
+
+// The clone's node of a frozen section, NULL while it has none
+static INISection *INISharedCopy(const INIShared *shared, const INISection *section)
+{
+    const INITable *copies = &shared->Copies;
+    if(copies->Capacity == 0)
+        return NULL;
+
+    size_t mask = copies->Capacity - 1;
+    for(size_t x = INIHashScoped(0, section) & mask; copies->Entries[x].Element != NULL; x = (x + 1) & mask)
+    {
+        if(copies->Entries[x].Scope == section && copies->Entries[x].Element != &INIIndexTombstone)
+            return copies->Entries[x].Element;
+    }
+
+    return NULL;
+}
+
+// The frozen section as the clone sees it, its copy or the section itself, NULL if the clone removed it
+static INISection *INISharedResolve(INI *INI, INISection *section)
+{
+    INISection *copy = INISharedCopy(INI->Shared, section);
+    if(copy == NULL)
+        return section;
+
+    return copy->Owner == INI ? copy : NULL;
+}
+
+// Sections of a clone follow the frozen list, where its copies take the place of the frozen sections, 
+// and go on with the sections added to it. Copies and added sections are told apart by their names, which copies share
+static INISection *INISectionAfter(INI *INI, INISection *section)
+{
+    INIShared *shared = INI->Shared;
+    if(shared == NULL || !INIFrozenContains(shared->Frozen, section->Name))
+        return section->NextSection;
+
+    for(INISection *next = section->NextSection; next != NULL; next = next->NextSection)
+    {
+        INISection *resolved = INISharedResolve(INI, next);
+        if(resolved != NULL)
+            return resolved;
+    }
+
+    return shared->FirstAdded;
+}
+
+// The last frozen section before the given place in the list that the clone still has
+static INISection *INISharedLastBefore(INI *INI, size_t ordinal)
+{
+    INIFrozen *frozen = INI->Shared->Frozen;
+    while(ordinal-- > 0)
+    {
+        INISection *resolved = INISharedResolve(INI, INIFrozenSection(frozen, ordinal));
+        if(resolved != NULL)
+            return resolved;
+    }
+
+    return NULL;
+}
+
+// Finds the first and last section of a clone, skipping the frozen ones it removed
+static void INISharedEnds(INI *INI)
+{
+    INIShared *shared = INI->Shared;
+    INI->FirstSection = shared->FirstAdded;
+    for(size_t x = 0; x < shared->Frozen->SectionCount; x++)
+    {
+        INISection *resolved = INISharedResolve(INI, INIFrozenSection(shared->Frozen, x));
+        if(resolved != NULL)
+        {
+            INI->FirstSection = resolved;
+            break;
+        }
+    }
+
+    INI->LastSection = shared->LastAdded != NULL ? shared->LastAdded : INISharedLastBefore(INI, shared->Frozen->SectionCount);
+}
+
+// Gives the clone a node of its own in place of a frozen section, which takes its place in the list
+static INISection *INISharedAddCopy(INI *INI, INISection *section)
+{
+    INISection *copy;
+    TryNotNull(copy = INIAllocate(INI, sizeof(*copy)), NULL);
+    *copy = *section;
+    copy->Owner = INI;
+    Try(INITableInsert(INI, &INI->Shared->Copies, INIHashScoped(0, section), section, copy), NULL);
+
+    if(INI->FirstSection == section)
+        INI->FirstSection = copy;
+    if(INI->LastSection == section)
+        INI->LastSection = copy;
+
+    INI->Version++;
+    return copy;
+}
+
+// Frozen sections are found in the frozen tables and then replaced by the clone's copies, unless it removed them
+static INISection *INISharedFindSection(INI *INI, const char *sectionName, size_t length, uint32_t hash)
+{
+    INISection *section = INIFrozenFindSection(INI->Shared->Frozen, sectionName, length, hash, INI->Stats);
+    return section != NULL ? INISharedResolve(INI, section) : NULL;
+}
+
+// The hash is only used with an index or a frozen INI
+// Interned names are equal to a stored name only if they are the same pointer
+static INISection *INIFindSectionHashed(INI *INI, const char *sectionName, size_t length, uint32_t hash, int interned)
+{
+    INIStatsAdd(INI->Stats, Lookups, 1);
+
+    if(INI->Frozen != NULL)
+        return INIFrozenFindSection(INI->Frozen, sectionName, length, hash, INI->Stats);
+
+    if(INI->Index != NULL)
+    {
+        INIIndexEntry *entry = INITableFind(&INI->Index->Sections, hash, NULL, sectionName, length, INI->Stats);
+        if(entry != NULL || INI->Shared == NULL)
+            return entry == NULL ? NULL : entry->Element;
+
+        return INISharedFindSection(INI, sectionName, length, hash);
+    }
+
+    if(interned)
+    {
+        for(INISection *section = INI->FirstSection; section != NULL; section = section->NextSection)
+        {
+            INIStatsAdd(INI->Stats, Probes, 1);
+            if(section->Name == sectionName)
+                return section;
+        }
+
+        return NULL;
+    }
+
+    for(INISection *section = INI->FirstSection; section != NULL; section = section->NextSection)
+    {
+        INIStatsAdd(INI->Stats, Probes, 1);
+        if(ININameEquals(section->Name, sectionName, length))
+            return section;
+    }
+    
+    return NULL;
+}
+
+static INISection *INIFindSectionView(INI *INI, const char *sectionName, size_t length)
+{
+    uint32_t hash = INI->Frozen != NULL || INI->Index != NULL ? INIHash(sectionName, length) : 0;
+    return INIFindSectionHashed(INI, sectionName, length, hash, 0);
+}
+
+INISection *INIFindSection(INI *INI, char *sectionName)
+{
+    Assert(INI, EINVAL, NULL);
+    Assert(sectionName, EINVAL, NULL);
+
+    return INIFindSectionView(INI, sectionName, strlen(sectionName));
+}
+
+INISection *ININextSection(INI *INI, INISection *section)
+{
+    Assert(INI, EINVAL, NULL);
+    Assert(section, EINVAL, NULL);
+
+    return INISectionAfter(INI, section);
+}
+
+// Gives a frozen section of a clone a node of its own, other sections are returned as they are
+static INISection *INIOwnSection(INI *INI, INISection *section)
+{
+    if(!INIIsShared(INI, section))
+        return section;
+
+    INISection *copy = INISharedCopy(INI->Shared, section);
+    if(copy == NULL)
+        return INISharedAddCopy(INI, section);
+
+    AssertMsg(copy->Owner == INI, EINVAL, NULL, "The section is not in the INI");
+    return copy;
+}
+
+// Links a new section to the end of the list, which for a clone is the end of the sections added to it
+static void INIAppendSection(INI *INI, INISection *section)
+{
+    INISection **first = &INI->FirstSection, **last = &INI->LastSection;
+    if(INI->Shared != NULL)
+    {
+        first = &INI->Shared->FirstAdded;
+        last = &INI->Shared->LastAdded;
+        if(INI->FirstSection == NULL)
+            INI->FirstSection = section;
+        INI->LastSection = section;
+    }
+
+    section->NextSection = NULL;
+    if(*last == NULL)
+        *first = section;
+    else
+        (*last)->NextSection = section;
+    *last = section;
+}
+
+// Takes a removed section out of a clone. Only added sections are unlinked, removed copies are passed over from then on
+static void INISharedUnlink(INI *INI, INISection *section)
+{
+    INIShared *shared = INI->Shared;
+    INISection *previous = NULL;
+    int added = !INIFrozenContains(shared->Frozen, section->Name);
+
+    if(added && shared->FirstAdded == section)
+        shared->FirstAdded = section->NextSection;
+    else if(added)
+    {
+        previous = shared->FirstAdded;
+        while(previous != NULL && previous->NextSection != section)
+            previous = previous->NextSection;
+        if(previous == NULL)
+            return;
+
+        previous->NextSection = section->NextSection;
+    }
+
+    if(added && shared->LastAdded == section)
+        shared->LastAdded = previous;
+
+    if(INI->FirstSection == section)
+        INI->FirstSection = INISectionAfter(INI, section);
+    if(INI->LastSection == section)
+        INI->LastSection = previous != NULL ? previous : INISharedLastBefore(INI, added ? shared->Frozen->SectionCount : INIFrozenOrdinal(shared->Frozen, section->Name));
+}
+
+int INIRemoveSection(INI *INI, INISection *section)
+{
+    Assert(INI, EINVAL, -1);
+    Assert(section, EINVAL, -1);
+    AssertMsg(INI->Frozen == NULL, EPERM, -1, FrozenMessage);
+
+    // A clone removes its own node of a frozen section, which is left without an owner to mark the section as removed
+    if(INIIsShared(INI, section))
+        TryNotNull(section = INIOwnSection(INI, section), -1);
+
+    if(INI->Index != NULL && section->Owner == INI)
+    {
+        INITableRemove(&INI->Index->Sections, INIHash(section->Name, strlen(section->Name)), section);
+
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            INITableRemove(&INI->Index->Pairs, INIHashScoped(INIHash(pair->Key, strlen(pair->Key)), section), pair);
+    }
+
+    if(INIJournaling(INI) && section->Owner == INI)
+    {
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            INIJournalUntrack(INI, pair);
+        Try(INIJournalChange(INI, INIJournalRemoveSection, section->Name, NULL, INITypeInvalid, NULL), -1);
+    }
+
+    // Removed sections are no longer covered by the index
+    section->Owner = NULL;
+    INI->Version++;
+
+    if(INI->Shared != NULL)
+    {
+        INISharedUnlink(INI, section);
+        return 0;
+    }
+
+    if(INI->FirstSection == section)
+    {
+        INI->FirstSection = section->NextSection;
+        if(INI->LastSection == section)
+            INI->LastSection = NULL;
+        return 0;
+    }
+
+    for(INISection *iteratingSection = INI->FirstSection; iteratingSection != NULL; iteratingSection = iteratingSection->NextSection)
+    {
+        if(iteratingSection->NextSection == section)    
+        {
+            iteratingSection->NextSection = section->NextSection;
+            if(INI->LastSection == section)
+                INI->LastSection = iteratingSection;
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+static void *INIAddLinkedListElement(INI *INI, void **firstElement, void **lastElement, size_t elementSize, size_t nextElementOffset)
+{
+    Assert(INI, EINVAL, NULL);
+    Assert(firstElement, EINVAL, NULL);
+    Assert(lastElement, EINVAL, NULL);
+    Assert(nextElementOffset < elementSize, EINVAL, NULL);
+
+    void *newElement;
+    TryNotNull(newElement = INIAllocate(INI, elementSize), NULL);
+    *(void **)((char *)newElement + nextElementOffset) = NULL;
+    INI->Version++;
+
+    if(*lastElement == NULL)
+        *firstElement = newElement;
+    else
+        *(void **)((char *)*lastElement + nextElementOffset) = newElement;
+
+    *lastElement = newElement;
+    return newElement;
+}
+
+static char *INIStoreString(INI *INI, const char *string, size_t length)
+{
+    char *storedString;
+    TryNotNull(storedString = INIAllocateAligned(INI, length + 1, 1), NULL);
+    memcpy(storedString, string, length);
+    storedString[length] = '\0';
+
+    return storedString;
+}
+
+// Strings inside the in place range of a stream are terminated where they are instead of being copied to the arena
+static char *INIStoreStreamString(INI *INI, INIStream *stream, const char *string, size_t length)
+{
+    if(stream != NULL && stream->InPlaceEnd != NULL && string >= stream->InPlaceBegin && string + length < stream->InPlaceEnd)
+    {
+        char *storedString = (char *)string;
+        storedString[length] = '\0';
+        return storedString;
+    }
+
+    return INIStoreString(INI, string, length);
+}
+
+// Returns the shared copy of the name, adding the stored name as that copy or storing the name first if there is no stored name
+static char *INIInternName(INI *INI, INIStream *stream, const char *name, size_t length, char *storedName)
+{
+    uint32_t hash = INIHash(name, length);
+    INIIndexEntry *entry = INITableFind(&INI->Strings->Names, hash, NULL, name, length, NULL);
+    if(entry != NULL)
+        return *(char **)entry->Element;
+
+    char **slot;
+    TryNotNull(slot = INIAllocateAligned(INI, sizeof(*slot), _Alignof(char *)), NULL);
+    if(storedName == NULL)
+        TryNotNull(storedName = INIStoreStreamString(INI, stream, name, length), NULL);
+
+    *slot = storedName;
+    Try(INITableInsert(INI, &INI->Strings->Names, hash, NULL, slot), NULL);
+
+    return storedName;
+}
+
+static char *INIStoreName(INI *INI, INIStream *stream, const char *name, size_t length)
+{
+    if(INI->Strings != NULL)
+        return INIInternName(INI, stream, name, length, NULL);
+
+    return INIStoreStreamString(INI, stream, name, length);
+}
+
+// Points every name of the INI to its shared copy, which is the first name of its kind
+static int INIInternAll(INI *INI)
+{
+    for(INISection *section = INI->FirstSection; section != NULL; section = section->NextSection)
+    {
+        TryNotNull(section->Name = INIInternName(INI, NULL, section->Name, strlen(section->Name), section->Name), -1);
+
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            TryNotNull(pair->Key = INIInternName(INI, NULL, pair->Key, strlen(pair->Key), pair->Key), -1);
+    }
+
+    return 0;
+}
+
+int INIEnableInterning(INI *INI)
+{
+    Assert(INI, EINVAL, -1);
+
+    // Clones share their names with the frozen contents
+    if(INI->Strings != NULL || INI->Frozen != NULL || INI->Shared != NULL)
+        return 0;
+
+    INIStrings *strings;
+    TryNotNull(strings = INIAllocate(INI, sizeof(*strings)), -1);
+    memset(strings, 0, sizeof(*strings));
+    INI->Strings = strings;
+
+    Try(INIInternAll(INI), -1, INI->Strings = NULL;);
+    return 0;
+}
+
+static INISection *INIAddSectionView(INI *INI, INIStream *stream, const char *sectionName, size_t length)
+{
+    AssertMsg(INI->Frozen == NULL, EPERM, NULL, FrozenMessage);
+    AssertMsg(INIFindSectionView(INI, sectionName, length) == NULL, EINVAL, NULL, "Cannot add a section with a name that is already in use by another section");
+
+    char *storedSectionName;
+    TryNotNull(storedSectionName = INIStoreName(INI, stream, sectionName, length), NULL);
+
+    INISection *newSection;
+    TryNotNull(newSection = INIAllocate(INI, sizeof(*newSection)), NULL);
+    INIAppendSection(INI, newSection);
+    INI->Version++;
+    newSection->Name = storedSectionName;
+    newSection->FirstPair = NULL;
+    newSection->LastPair = NULL;
+    newSection->Owner = INI;
+    INIStatsAdd(INI->Stats, SectionsAdded, 1);
+
+    if(INI->Index != NULL)
+        Try(INIIndexAddSection(INI, newSection), NULL);
+
+    return newSection;
+}
+
+INISection *INIAddSection(INI *INI, char *sectionName)
+{
+    Assert(INI, EINVAL, NULL);
+    Assert(sectionName, EINVAL, NULL);
+
+    INISection *section;
+    TryNotNull(section = INIAddSectionView(INI, NULL, sectionName, strlen(sectionName)), NULL);
+
+    if(INIJournaling(INI))
+        Try(INIJournalChange(INI, INIJournalAddSection, section->Name, NULL, INITypeInvalid, NULL), NULL);
+
+    return section;
+}
+
+// Strings of the frozen contents a clone shares stay where they are, others are copied
+static char *INIShareString(INI *INI, char *string, size_t length)
+{
+    return INIIsShared(INI, string) ? string : INIStoreString(INI, string, length);
+}
+
+static INIPair *INICopyPair(INI *INI, INISection *section, const INIPair *pair)
+{
+    char *key;
+    TryNotNull(key = INIShareString(INI, pair->Key, strlen(pair->Key)), NULL);
+
+    INIPair *copy;
+    TryNotNull(copy = INIAddLinkedListElement(INI, (void **)&section->FirstPair, (void **)&section->LastPair, sizeof(*copy), offsetof(INIPair, NextPair)), NULL);
+    copy->Key = key;
+    copy->Value = pair->Value;
+    copy->Type = pair->Type;
+    copy->RawLength = pair->RawLength;
+
+    if(pair->RawLength != 0 || pair->Type == INITypeString)
+        TryNotNull(copy->Value = INIShareString(INI, pair->Value, pair->RawLength != 0 ? pair->RawLength : strlen(pair->Value)), NULL);
+
+    if(INI->Index != NULL)
+        Try(INIIndexAddPair(INI, section, copy), NULL);
+    if(INI->Journal != NULL)
+        Try(INIJournalTrack(INI, section, copy), NULL);
+
+    return copy;
+}
+
+// Gives a section of a clone pairs of its own before they change, their keys and values stay shared
+static int INIUnsharePairs(INI *INI, INISection *section)
+{
+    if(!INIIsShared(INI, section->FirstPair))
+        return 0;
+
+    INIPair *pair = section->FirstPair;
+    section->FirstPair = NULL;
+    section->LastPair = NULL;
+
+    for(; pair != NULL; pair = pair->NextPair)
+        TryNotNull(INICopyPair(INI, section, pair), -1);
+
+    return 0;
+}
+
+static INIPair *INIFindPairHashed(INISection *section, const char *key, size_t length, uint32_t hash, int interned)
+{
+    INI *owner = section->Owner;
+    INIStats *stats = owner != NULL ? owner->Stats : NULL;
+    INIStatsAdd(stats, Lookups, 1);
+
+    // Pairs a clone still shares are laid out like those of a frozen INI and are not in its index
+    int frozenPairs = owner != NULL && (owner->Frozen != NULL || INIIsShared(owner, section->FirstPair));
+    if(frozenPairs)
+    {
+        if(section->FirstPair == NULL)
+            return NULL;
+
+        // Small sections are scanned directly, larger ones have their sorted entries right after their pairs
+        size_t count = section->LastPair - section->FirstPair + 1;
+        if(count > FrozenLinearSearchMax)
+            return INIFrozenFind((INIFrozenEntry *)(section->LastPair + 1), count, section->FirstPair, sizeof(INIPair), key, length, hash, stats);
+    }
+
+    if(!frozenPairs && owner != NULL && owner->Index != NULL)
+    {
+        INIIndexEntry *entry = INITableFind(&owner->Index->Pairs, INIHashScoped(hash, section), section, key, length, stats);
+        return entry == NULL ? NULL : entry->Element;
+    }
+
+    if(interned)
+    {
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+        {
+            INIStatsAdd(stats, Probes, 1);
+            if(pair->Key == key)
+                return pair;
+        }
+
+        return NULL;
+    }
+
+    for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+    {
+        INIStatsAdd(stats, Probes, 1);
+        if(ININameEquals(pair->Key, key, length))
+            return pair;
+    }
+
+    return NULL;
+}
+
+static INIPair *INIFindPairView(INISection *section, const char *key, size_t length)
+{
+    INI *owner = section->Owner;
+    uint32_t hash = owner != NULL && (owner->Frozen != NULL || owner->Index != NULL) ? INIHash(key, length) : 0;
+    return INIFindPairHashed(section, key, length, hash, 0);
+}
+
+static INIPair *INIAddPair(INI *INI, INIStream *stream, INISection *section, const char *key, size_t length)
+{
+    Assert(INI, EINVAL, NULL);
+    Assert(section, EINVAL, NULL);
+    Assert(key, EINVAL, NULL);
+    AssertMsg(INI->Frozen == NULL, EPERM, NULL, FrozenMessage);
+    TryNotNull(section = INIOwnSection(INI, section), NULL);
+    AssertMsg(INIFindPairView(section, key, length) == NULL, EINVAL, NULL, "Cannot add a pair with a key that is already in use by another pair");
+
+    if(section->Owner == INI)
+        Try(INIUnsharePairs(INI, section), NULL);
+
+    char *storedKeyName;
+    TryNotNull(storedKeyName = INIStoreName(INI, stream, key, length), NULL);
+
+    INIPair *newPair;
+    TryNotNull(newPair = INIAddLinkedListElement(INI, (void **)&section->FirstPair, (void **)&section->LastPair, sizeof(*newPair), offsetof(INIPair, NextPair)), NULL);
+    newPair->Key = storedKeyName;
+    newPair->Value = NULL;
+    newPair->Type = INITypeInvalid;
+    newPair->RawLength = 0;
+    INIStatsAdd(INI->Stats, PairsAdded, 1);
+
+    if(INI->Index != NULL && section->Owner == INI)
+        Try(INIIndexAddPair(INI, section, newPair), NULL);
+    if(INI->Journal != NULL && section->Owner == INI)
+        Try(INIJournalTrack(INI, section, newPair), NULL);
+
+    return newPair;
+}
+
+INIPair *INIFindPair(INISection *section, char *key)
+{
+    Assert(section, EINVAL, NULL);
+    Assert(key, EINVAL, NULL);
+
+    return INIFindPairView(section, key, strlen(key));
+}
+
+INIKey INIKeyMake(const char *name)
+{
+    size_t length = name != NULL ? strlen(name) : 0;
+    return (INIKey){name, length, INIHash(name, length), NULL};
+}
+
+int INIInternKey(INI *INI, const char *name, INIKey *key)
+{
+    Assert(INI, EINVAL, -1);
+    Assert(name, EINVAL, -1);
+    Assert(key, EINVAL, -1);
+    AssertMsg(INI->Strings != NULL, EINVAL, -1, "Keys can only be interned by an INI with interning enabled");
+
+    size_t length = strlen(name);
+    char *sharedName;
+    TryNotNull(sharedName = INIInternName(INI, NULL, name, length, NULL), -1);
+
+    *key = (INIKey){sharedName, length, INIHash(name, length), INI};
+    return 0;
+}
+
+INISection *INIFindSectionByKey(INI *INI, const INIKey *key)
+{
+    Assert(INI, EINVAL, NULL);
+    Assert(key && key->Name, EINVAL, NULL);
+
+    return INIFindSectionHashed(INI, key->Name, key->Length, key->Hash, key->Interned == INI && INI->Strings != NULL);
+}
+
+INIPair *INIFindPairByKey(INISection *section, const INIKey *key)
+{
+    Assert(section, EINVAL, NULL);
+    Assert(key && key->Name, EINVAL, NULL);
+
+    INI *owner = section->Owner;
+    return INIFindPairHashed(section, key->Name, key->Length, key->Hash, owner != NULL && key->Interned == owner && owner->Strings != NULL);
+}
+
+// Finds the copy of a shared pair in the clone, giving its section pairs of its own first
+static INIPair *INIUnsharePair(INI *INI, INIPair *pair)
+{
+    INISection *section;
+    TryNotNull(section = INIOwnSection(INI, INIFrozenSectionOf(INI->Shared->Frozen, pair)), NULL);
+    Try(INIUnsharePairs(INI, section), NULL);
+
+    INIPair *copy = INIFindPairView(section, pair->Key, strlen(pair->Key));
+    AssertMsg(copy != NULL, EINVAL, NULL, NotInINIMessage);
+    return copy;
+}
+
+static int INIUnlinkPair(INISection *section, INIPair *pair)
+{
+    if(section->FirstPair == pair)
+    {
+        section->FirstPair = pair->NextPair;
+        if(section->LastPair == pair)
+            section->LastPair = NULL;
+        return 0;
+    }
+
+    for(INIPair *iterPair = section->FirstPair; iterPair != NULL; iterPair = iterPair->NextPair)
+    {
+        if(iterPair->NextPair == pair)
+        {
+            iterPair->NextPair = pair->NextPair;
+            if(section->LastPair == pair)
+                section->LastPair = iterPair;
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+int INIRemovePairFrom(INI *INI, INISection *section, INIPair *pair)
+{
+    Assert(INI, EINVAL, -1);
+    Assert(section, EINVAL, -1);
+    Assert(pair, EINVAL, -1);
+    AssertMsg(INI->Frozen == NULL, EPERM, -1, FrozenMessage);
+
+    // A clone removes the pair from its own copy of a frozen section
+    if(INIIsShared(INI, section) || INIIsShared(INI, pair))
+    {
+        TryNotNull(section = INIOwnSection(INI, section), -1);
+        Try(INIUnsharePairs(INI, section), -1);
+        if(INIIsShared(INI, pair) && (pair = INIFindPairView(section, pair->Key, strlen(pair->Key))) == NULL)
+            return 0;
+    }
+
+    AssertMsg(section->Owner == INI, EINVAL, -1, "The section is not in the INI");
+
+    if(INI->Index != NULL)
+        INITableRemove(&INI->Index->Pairs, INIHashScoped(INIHash(pair->Key, strlen(pair->Key)), section), pair);
+    INI->Version++;
+
+    if(INIJournaling(INI))
+    {
+        INIJournalUntrack(INI, pair);
+        Try(INIJournalChange(INI, INIJournalRemovePair, section->Name, pair->Key, INITypeInvalid, NULL), -1);
+    }
+
+    return INIUnlinkPair(section, pair);
+}
+
+int INIRemovePair(INISection *section, INIPair *pair)
+{
+    Assert(section, EINVAL, -1);
+    Assert(pair, EINVAL, -1);
+
+    // Frozen sections a clone has not changed are owned by the frozen INI, so they cannot be told apart from its sections
+    INI *owner = section->Owner;
+    AssertMsg(owner == NULL || owner->Frozen == NULL, EPERM, -1, FrozenMessage);
+
+    if(owner != NULL)
+        return INIRemovePairFrom(owner, section, pair);
+
+    return INIUnlinkPair(section, pair);
+}
+
+int INIFindAndRemovePair(INISection *section, char *key)
+{
+    INIPair *pair;
+    TryNotNull(pair = INIFindPair(section, key), -1);
+    Try(INIRemovePair(section, pair), -1);
+
+    return 0;
+}
+
+static int INIJournalTrackAll(INI *INI)
+{
+    INIJournal *journal = INI->Journal;
+    memset(&journal->Pairs, 0, sizeof(journal->Pairs));
+
+    size_t pairCount = 0;
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section))
+    {
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            pairCount++;
+    }
+
+    Try(INITableReserve(INI, &journal->Pairs, pairCount), -1);
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section))
+    {
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            Try(INIJournalTrack(INI, section, pair), -1);
+    }
+
+    return 0;
+}
+
+int INIEnableJournal(INI *INI, enum INIJournalSync sync, size_t compactSize)
+{
+    Assert(INI, EINVAL, -1);
+    AssertMsg(INI->Frozen == NULL, EPERM, -1, FrozenMessage);
+
+    if(INI->Journal == NULL)
+    {
+        TryNotNull(INI->Journal = calloc(1, sizeof(*INI->Journal)), -1);
+        Try(INIJournalTrackAll(INI), -1, free(INI->Journal); INI->Journal = NULL;);
+    }
+
+    INI->Journal->Sync = sync;
+    INI->Journal->CompactSize = compactSize;
+    return 0;
+}
+
+int INIJournalFlush(INI *INI)
+{
+    Assert(INI, EINVAL, -1);
+    AssertMsg(INI->Journal != NULL && INI->Journal->Log != NULL, EINVAL, -1, NoJournalMessage);
+
+    return INIJournalSyncFile(INI->Journal->Log);
+}
+
+int INIEnableStats(INI *INI)
+{
+    Assert(INI, EINVAL, -1);
+
+#ifdef INI_STATS
+    if(INI->Stats == NULL)
+        TryNotNull(INI->Stats = calloc(1, sizeof(*INI->Stats)), -1);
+
+    return 0;
+#else
+    Throw(ENOTSUP, -1, "Statistics are only counted in builds with INI_STATS");
+#endif
+}
+
+// There is no atomic add for floating point, so the sum is swapped in until no other thread got in between
+static void INIStatsAddSeconds(double *field, double seconds)
+{
+    _Atomic(double) *counted = (_Atomic(double) *)field;
+    double expected = atomic_load_explicit(counted, memory_order_relaxed);
+    while(!atomic_compare_exchange_weak_explicit(counted, &expected, expected + seconds, memory_order_relaxed, memory_order_relaxed));
+}
+
+// Adds the counters of another INI, which do not include its arena. Both may be counted into by other threads meanwhile
+static void INIStatsMerge(INIStats *stats, INIStats *other)
+{
+#define INIStatsMergeField(field) atomic_fetch_add_explicit((_Atomic(uint64_t) *)&stats->field, \
+    atomic_load_explicit((_Atomic(uint64_t) *)&other->field, memory_order_relaxed), memory_order_relaxed)
+#define INIStatsMergeSeconds(field) INIStatsAddSeconds(&stats->field, atomic_load_explicit((_Atomic(double) *)&other->field, memory_order_relaxed))
+
+    INIStatsMergeField(Lines);
+    INIStatsMergeField(Bytes);
+    INIStatsMergeField(SectionsAdded);
+    INIStatsMergeField(PairsAdded);
+    for(size_t x = 0; x < sizeof(stats->Failures) / sizeof(*stats->Failures); x++)
+        INIStatsMergeField(Failures[x]);
+    INIStatsMergeField(Lookups);
+    INIStatsMergeField(Probes);
+    INIStatsMergeSeconds(ReadSeconds);
+    INIStatsMergeSeconds(ParseSeconds);
+    INIStatsMergeSeconds(WriteSeconds);
+
+#undef INIStatsMergeField
+#undef INIStatsMergeSeconds
+}
+
+int INIGetStats(INI *INI, INIStats *stats)
+{
+    Assert(INI, EINVAL, -1);
+    Assert(stats, EINVAL, -1);
+    AssertMsg(INI->Stats != NULL, EINVAL, -1, "Statistics have not been enabled");
+
+    // Other threads may still be counting, so every counter is read atomically
+    *stats = (INIStats){0};
+    INIStatsMerge(stats, INI->Stats);
+    stats->AverageProbes = stats->Lookups != 0 ? (double)stats->Probes / stats->Lookups : 0;
+
+    // Blocks up to the current one have been filled, the ones after it are spare
+    int spare = 0;
+    for(INIArena *arena = INIFirstArena(INI); arena != NULL; arena = arena->NextArena)
+    {
+        size_t used = arena->Used - INIArenaHeaderSize();
+        stats->ArenaBlocks++;
+        stats->ArenaUsed += used;
+
+        if(spare || arena == INI->Arena)
+            stats->ArenaFree += arena->Size - arena->Used;
+        else
+            stats->ArenaWasted += arena->Size - arena->Used;
+
+        spare |= arena == INI->Arena;
+    }
+
+    return 0;
+}
+
+
+int INIEnableLazyValues(INI *INI)
+{
+    Assert(INI, EINVAL, -1);
+
+    INI->LazyValues = 1;
+    return 0;
+}
+
+// Converts a lazily read float, its text is terminated where it is stored
+static void INIDecodeValue(INIPair *pair)
+{
+    if(pair->RawLength == 0)
+        return;
+
+    const char *raw = pair->Value;
+    double value;
+
+    // Hexadecimal floats, infinities and NaNs are left to strtod
+    if(INIParseFloat(raw, pair->RawLength, &value) != pair->RawLength)
+        value = strtod(raw, NULL);
+
+    pair->Float = value;
+    pair->RawLength = 0;
+}
+
+void INIDecodeValues(INI *INI)
+{
+    if(!INI->LazyValues)
+        return;
+
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section))
+    {
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            INIDecodeValue(pair);
+    }
+}
+
+void *INIGetValue(INIPair *pair, enum INIType type)
+{
+    Assert(pair, EINVAL, NULL);
+
+    AssertMsg(pair->Type == type, EINVAL, NULL, PairTypeMismatchMessage);
+
+    INIDecodeValue(pair);
+
+    switch(type)
+    {
+        case INITypeInt:
+            return &pair->Int;
+        case INITypeFloat:
+            return &pair->Float;
+        default:
+            return pair->Value;
+    }
+}
+
+void *INIFindValue(INISection *section, char *key, enum INIType type)
+{
+    INIPair *pair = INIFindPair(section, key);
+    return pair ? INIGetValue(pair, type) : NULL;
+}
+
+// Hashes a batch of keys and prefetches their buckets before probing for any of them, so the cache misses overlap
+static void INIFindValuesHashed(INISection *section, INILookup *lookups, size_t count)
+{
+    INI *owner = section->Owner;
+
+    for(size_t batch = 0; batch < count; batch += LookupBatchSize)
+    {
+        size_t batchCount = count - batch < LookupBatchSize ? count - batch : LookupBatchSize;
+        uint32_t hashes[LookupBatchSize];
+        size_t lengths[LookupBatchSize];
+
+        for(size_t x = 0; x < batchCount; x++)
+        {
+            lengths[x] = strlen(lookups[batch + x].Key);
+            hashes[x] = INIHash(lookups[batch + x].Key, lengths[x]);
+
+#ifdef __GNUC__
+            if(owner->Index != NULL && owner->Index->Pairs.Capacity != 0)
+                __builtin_prefetch(owner->Index->Pairs.Entries + (INIHashScoped(hashes[x], section) & (owner->Index->Pairs.Capacity - 1)));
+#endif
+        }
+
+        for(size_t x = 0; x < batchCount; x++)
+            lookups[batch + x].Pair = INIFindPairHashed(section, lookups[batch + x].Key, lengths[x], hashes[x], 0);
+    }
+}
+
+// Walks the section once, looking each key up in a table of the wanted ones. Keys wanted twice are in the table twice
+static int INIFindValuesScanned(INISection *section, INILookup *lookups, size_t count)
+{
+    size_t capacity = INITableCapacity(count);
+    size_t stackSlots[LookupStackSlots];
+    size_t *slots = stackSlots;
+    if(capacity > LookupStackSlots)
+        TryNotNull(slots = malloc(capacity * sizeof(*slots)), -1);
+
+    // Slots hold the index of a lookup plus one, 0 is empty
+    memset(slots, 0, capacity * sizeof(*slots));
+    size_t mask = capacity - 1;
+    for(size_t x = 0; x < count; x++)
+    {
+        size_t slot = INIHash(lookups[x].Key, strlen(lookups[x].Key)) & mask;
+        while(slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        slots[slot] = x + 1;
+    }
+
+    INIStats *stats = section->Owner != NULL ? section->Owner->Stats : NULL;
+    size_t found = 0;
+    for(INIPair *pair = section->FirstPair; pair != NULL && found < count; pair = pair->NextPair)
+    {
+        INIStatsAdd(stats, Probes, 1);
+
+        size_t length = strlen(pair->Key);
+        for(size_t slot = INIHash(pair->Key, length) & mask; slots[slot] != 0; slot = (slot + 1) & mask)
+        {
+            INILookup *lookup = lookups + slots[slot] - 1;
+            if(lookup->Pair == NULL && ININameEquals(pair->Key, lookup->Key, length))
+            {
+                lookup->Pair = pair;
+                found++;
+            }
+        }
+    }
+
+    if(slots != stackSlots)
+        free(slots);
+
+    return 0;
+}
+
+int INIFindValues(INISection *section, INILookup *lookups, size_t count)
+{
+    Assert(section, EINVAL, -1);
+    Assert(lookups || count == 0, EINVAL, -1);
+
+    for(size_t x = 0; x < count; x++)
+    {
+        Assert(lookups[x].Key, EINVAL, -1);
+        lookups[x].Pair = NULL;
+        lookups[x].Value = NULL;
+    }
+
+    INI *owner = section->Owner;
+    INIStatsAdd(owner != NULL ? owner->Stats : NULL, Lookups, count);
+
+    if(owner != NULL && (owner->Index != NULL || owner->Frozen != NULL))
+        INIFindValuesHashed(section, lookups, count);
+    else
+        Try(INIFindValuesScanned(section, lookups, count), -1);
+
+    int found = 0;
+    for(size_t x = 0; x < count; x++)
+    {
+        INILookup *lookup = lookups + x;
+        if(lookup->Pair == NULL)
+            lookup->Status = INILookupStatusMissing;
+        else if(lookup->Pair->Type != lookup->Type)
+            lookup->Status = INILookupStatusTypeMismatch;
+        else
+        {
+            lookup->Status = INILookupStatusFound;
+            lookup->Value = INIGetValue(lookup->Pair, lookup->Type);
+            found++;
+        }
+    }
+
+    return found;
+}
+
+INIPair *INIAddValue(INI *INI, INISection *section, char *key, enum INIType type, void *value)
+{
+    // Callees have asserts
+
+    INIPair *pair;
+    TryNotNull(pair = INIAddPair(INI, NULL, section, key, strlen(key)), NULL);
+    Try(INISetValue(INI, pair, type, value), NULL);
+
+    return pair;
+}
+
+int INISetValue(INI *INI, INIPair *pair, enum INIType type, void *value)
+{
+    Assert(pair, EINVAL, -1);
+    Assert(value, EINVAL, -1);
+    AssertMsg(INI == NULL || INI->Frozen == NULL, EPERM, -1, FrozenMessage);
+
+    if(INIIsShared(INI, pair))
+        TryNotNull(pair = INIUnsharePair(INI, pair), -1);
+
+    switch(type)
+    {
+        case INITypeString:
+        {
+            // A string that fits into the old one overwrites it, so values that are set over and over do not grow the arena
+            size_t length = strlen((char *)value);
+            if(pair->Type == INITypeString && pair->RawLength == 0 && length <= strlen(pair->Value) && !INIIsShared(INI, pair->Value))
+            {
+                memmove(pair->Value, value, length + 1);
+                break;
+            }
+
+            char *storedValue;
+            TryNotNull(storedValue = INIStoreString(INI, value, length), -1);
+            pair->Value = storedValue;
+            break;
+        }
+        case INITypeFloat:
+            pair->Float = *(double *)value;
+            break;
+        case INITypeInt:
+            pair->Int = *(int64_t *)value;
+            break;
+        default:
+            Throw(EINVAL, -1, "Invalid INIType detected while setting value");
+    }
+
+    pair->Type = type;
+    pair->RawLength = 0;
+
+    // Pairs that are not in the INI have nothing in its file to change
+    INISection *section = INIJournaling(INI) ? INIJournalSection(INI, pair) : NULL;
+    if(section != NULL)
+        Try(INIJournalChange(INI, INIJournalSetValue, section->Name, pair->Key, type, type == INITypeString ? pair->Value : value), -1);
+
+    return 0;
+}
+
+int INIFindAndSetValue(INI *INI, INISection *section, char *key, enum INIType type, void *value)
+{
+    // Callees have asserts
+
+    INIPair *pair;
+    TryNotNull(pair = INIFindPair(section, key), -1);
+    Try(INISetValue(INI, pair, type, value), -1);
+
+    return 0;
+}
+
+// Type safe functions for convenience
+
+char *INIGetString(INIPair *pair)
+{
+    return INIGetValue(pair, INITypeString);
+}
+
+char *INIFindString(INISection *section, char *key)
+{
+    return INIFindValue(section, key, INITypeString);
+}
+
+INIPair *INIAddString(INI *INI, INISection *section, char *key, char *string)
+{
+    return INIAddValue(INI, section, key, INITypeString, string);
+}
+
+int INISetString(INI *INI, INIPair *pair, char *string)
+{
+    return INISetValue(INI, pair, INITypeString, string);
+}
+
+int INIFindAndSetString(INI *INI, INISection *section, char *key, char *string)
+{
+    return INIFindAndSetValue(INI, section, key, INITypeString, string);
+}
+
+int64_t *INIGetInt(INIPair *pair)
+{
+    return INIGetValue(pair, INITypeInt);
+}
+
+int64_t *INIFindInt(INISection *section, char *key)
+{
+    return INIFindValue(section, key, INITypeInt);
+}
+
+INIPair *INIAddInt(INI *INI, INISection *section, char *key, int64_t integer)
+{
+    return INIAddValue(INI, section, key, INITypeInt, &integer);
+}
+
+int INISetInt(INI *INI, INIPair *pair, int64_t integer)
+{
+    return INISetValue(INI, pair, INITypeInt, &integer);
+}
+
+int INIFindAndSetInt(INI* INI, INISection *section, char *key, int64_t integer)
+{
+    return INIFindAndSetValue(INI, section, key, INITypeInt, &integer);
+}
+
+double *INIGetFloat(INIPair *pair)
+{
+    return INIGetValue(pair, INITypeFloat);
+}
+
+double *INIFindFloat(INISection *section, char *key)
+{
+    return INIFindValue(section, key, INITypeFloat);
+}
+
+int INIGetNumber(INIPair *pair, double *number)
+{
+    Assert(pair, EINVAL, -1);
+    Assert(number, EINVAL, -1);
+
+    if(pair->Type == INITypeInt)
+    {
+        *number = (double)pair->Int;
+        return 0;
+    }
+
+    double *value;
+    TryNotNull(value = INIGetValue(pair, INITypeFloat), -1);
+    *number = *value;
+    return 0;
+}
+
+int INIFindNumber(INISection *section, char *key, double *number)
+{
+    INIPair *pair = INIFindPair(section, key);
+    AssertMsg(pair != NULL, ENOENT, -1, "There is no pair with that key");
+    return INIGetNumber(pair, number);
+}
+
+INIPair *INIAddFloat(INI *INI, INISection *section, char *key, double number)
+{
+    return INIAddValue(INI, section, key, INITypeFloat, &number);
+}
+
+int INISetFloat(INI *INI, INIPair *pair, double number)
+{
+    return INISetValue(INI, pair, INITypeFloat, &number);
+}
+
+int INIFindAndSetFloat(INI* INI, INISection *section, char *key, double number)
+{
+    return INIFindAndSetValue(INI, section, key, INITypeFloat, &number);
+}
+
+static int INISetStringView(INI *INI, INIStream *stream, INIPair *pair, const char *string, size_t length)
+{
+    char *storedValue;
+    TryNotNull(storedValue = INIStoreStreamString(INI, stream, string, length), -1);
+
+    pair->Value = storedValue;
+    pair->Type = INITypeString;
+
+    return 0;
+}
+
+// Succeeds only if the whole string is a decimal integer that fits into an int64_t
+int INIParseInt(const char *string, size_t length, int64_t *integer)
+{
+    const char *end = string + length;
+    int negative = string < end && *string == '-';
+
+    if(string < end && (*string == '-' || *string == '+'))
+        string++;
+
+    // Up to 19 digits always fit into a uint64_t, longer numbers are left to the float path
+    if(string == end || end - string > 19)
+        return -1;
+
+    uint64_t magnitude = 0;
+    unsigned invalid = 0;
+
+    for(; string < end; string++)
+    {
+        unsigned digit = (unsigned char)*string - '0';
+        invalid |= digit > 9;
+        magnitude = magnitude * 10 + digit;
+    }
+
+    if(invalid || magnitude > (uint64_t)INT64_MAX + negative)
+        return -1;
+
+    *integer = negative ? -(int64_t)(magnitude - 1) - 1 : (int64_t)magnitude;
+    return 0;
+}
+
+static const char *INIFindNewline(const char *string, size_t length)
+{
+#ifdef __SSE2__
+    const __m128i newlines = _mm_set1_epi8('\n');
+    size_t x = 0;
+
+    for(; x + sizeof(__m128i) <= length; x += sizeof(__m128i))
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(string + x));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newlines));
+        if(mask != 0)
+            return string + x + __builtin_ctz(mask);
+    }
+
+    return memchr(string + x, '\n', length - x);
+#else
+    return memchr(string, '\n', length);
+#endif
+}
+
+// Parses a single line without its newline, the character after the line must not be part of a value (a newline or a null terminator)
+// A line split into views of its parts, shared by the parser that builds the INI and the one that only reports events
+typedef struct INILine
+{
+    enum INILineKind
+    {
+        INILineEmpty,
+        INILineSection,
+        INILinePair
+    } Kind;
+    const char *Name;
+    size_t NameLength;
+    const char *Value;
+    size_t ValueLength;
+    // Strings with broken quotes are INITypeInvalid, integers are parsed already, floats are left to the caller
+    enum INIType Type;
+    int64_t Int;
+} INILine;
+
+static int INILexLine(const char *line, size_t length, INILine *result)
+{
+    const char *end = line + length;
+    line = StripLeadingWhitespace(line, end);
+    result->Kind = INILineEmpty;
+
+    if(line == end || *line == '#')
+        return INIStreamStatusSuccess;
+
+    if(*line == '[')
+    {
+        const char *sectionName = line + 1;
+        const char *nameEnd = memchr(sectionName, ']', end - sectionName);
+
+        if(nameEnd == NULL || StripLeadingWhitespace(nameEnd + 1, end) != end)
+            return INIStreamStatusSectionHeaderParseFailed;
+
+        result->Kind = INILineSection;
+        result->Name = sectionName;
+        result->NameLength = nameEnd - sectionName;
+        return INIStreamStatusSuccess;
+    }
+
+    const char *separator = memchr(line, '=', end - line);
+    if(separator == NULL)
+        return INIStreamStatusPairParseFailed;
+
+    const char *value = StripLeadingWhitespace(separator + 1, end);
+    const char *valueEnd = StripEndingWhitespace(value, end);
+
+    result->Kind = INILinePair;
+    result->Name = line;
+    result->NameLength = StripEndingWhitespace(line, separator) - line;
+    result->Value = value;
+    result->ValueLength = valueEnd - value;
+
+    if(*value == '"')
+    {
+        result->Type = INITypeInvalid;
+        if(valueEnd - value >= 2 && valueEnd[-1] == '"')
+        {
+            result->Type = INITypeString;
+            result->Value++;
+            result->ValueLength -= 2;
+        }
+    }
+    else
+        result->Type = INIParseInt(value, valueEnd - value, &result->Int) == 0 ? INITypeInt : INITypeFloat;
+
+    return INIStreamStatusSuccess;
+}
+
+static int INIParseLine(INI *INI, INIStream *stream, const char *line, size_t length)
+{
+    INILine lexed;
+    int code = INILexLine(line, length, &lexed);
+
+    if(code == INIStreamStatusSectionHeaderParseFailed)
+        Throw(EINVAL, INIStreamStatusSectionHeaderParseFailed, "INI stream failed to parse section header");
+
+    if(lexed.Kind == INILineSection)
+    {
+        TryNotNull(stream->CurrentSection = INIAddSectionView(INI, stream, lexed.Name, lexed.NameLength), INIStreamStatusFatalFailure, 
+            if(errno == EINVAL)
+                Throw(EINVAL, INIStreamStatusSectionHeaderParseFailed, "INI stream failed to parse section header");
+        );
+
+        return INIStreamStatusSuccess;
+    }
+
+    // Pairs go to the section of the last parsed header, or to the end of the INI if there was none yet
+    INISection *section = stream->CurrentSection != NULL ? stream->CurrentSection : INI->LastSection;
+
+    if(code == INIStreamStatusPairParseFailed || (lexed.Kind == INILinePair && section == NULL))
+        Throw(EINVAL, INIStreamStatusPairParseFailed, "INI stream failed to parse pair");
+
+    if(lexed.Kind == INILineEmpty)
+        return INIStreamStatusSuccess;
+
+    INIPair *pair;
+    TryNotNull(pair = INIAddPair(INI, stream, section, lexed.Name, lexed.NameLength), INIStreamStatusFatalFailure,
+        if(errno == EINVAL)
+            Throw(EINVAL, INIStreamStatusPairParseFailed, "INI stream failed to parse pair");
+    );
+
+    switch(lexed.Type)
+    {
+        case INITypeString:
+            Try(INISetStringView(INI, stream, pair, lexed.Value, lexed.ValueLength), INIStreamStatusFatalFailure);
+            break;
+        case INITypeInt:
+            pair->Int = lexed.Int;
+            pair->Type = INITypeInt;
+            break;
+        case INITypeFloat:
+            pair->Type = INITypeFloat;
+            if(INI->LazyValues && lexed.ValueLength > 0 && lexed.ValueLength <= UINT32_MAX)
+            {
+                TryNotNull(pair->Value = INIStoreStreamString(INI, stream, lexed.Value, lexed.ValueLength), INIStreamStatusFatalFailure);
+                pair->RawLength = (uint32_t)lexed.ValueLength;
+                break;
+            }
+
+            // Hexadecimal floats, infinities and NaNs are left to strtod, which stops at the newline or null terminator that follows the line at the latest
+            if(INIParseFloat(lexed.Value, lexed.ValueLength, &pair->Float) != lexed.ValueLength)
+                pair->Float = strtod(lexed.Value, NULL);
+            break;
+        default:
+            Throw(EINVAL, INIStreamStatusPairParseFailed, "INI stream failed to parse pair");
+    }
+
+    return INIStreamStatusSuccess;
+}
+
+// Reports a line to the handlers instead of adding it to an INI
+static int INIReportLine(const INIHandlers *handlers, const char *line, size_t length)
+{
+    INILine lexed;
+    int code = INILexLine(line, length, &lexed);
+    int stop = 0;
+
+    if(code == INIStreamStatusSuccess && lexed.Kind == INILinePair && lexed.Type == INITypeInvalid)
+        code = INIStreamStatusPairParseFailed;
+
+    if(code != INIStreamStatusSuccess)
+    {
+        if(handlers->Error != NULL)
+            stop = handlers->Error(handlers->Context, code, line, length);
+    }
+    else if(lexed.Kind == INILineSection && handlers->Section != NULL)
+        stop = handlers->Section(handlers->Context, lexed.Name, lexed.NameLength);
+    else if(lexed.Kind == INILinePair && handlers->Pair != NULL)
+        stop = handlers->Pair(handlers->Context, lexed.Name, lexed.NameLength, lexed.Value, lexed.ValueLength, lexed.Type);
+
+    return stop ? INIStreamStatusStopped : INIStreamStatusSuccess;
+}
+
+// Splits the current chunk into lines, which are added to the INI, or reported to the handlers if there are any
+static int INIStreamLines(INI *INI, INIStream *stream, const INIHandlers *handlers)
+{
+    ListChar *lineBuffer = (ListChar *)&stream->LineBuffer;
+    INIStats *stats = INI != NULL ? INI->Stats : NULL;
+
+    if(stream->IOStreamCount == 0)
+    {
+        // An empty chunk marks the end of the input, which also ends its last line
+        if(lineBuffer->Count == 0)
+            return INIStreamStatusSuccess;
+
+        const char terminator = '\0';
+        Try(ListAdd(lineBuffer, &terminator), INIStreamStatusFatalFailure);
+
+        INIStatsAdd(stats, Lines, 1);
+        INIStatsAdd(stats, Bytes, lineBuffer->Count - 1);
+
+        int code = handlers != NULL ? INIReportLine(handlers, lineBuffer->V, lineBuffer->Count - 1) : INIParseLine(INI, stream, lineBuffer->V, lineBuffer->Count - 1);
+        ListClear(lineBuffer);
+        if(code > INIStreamStatusContinue && code < INIStreamStatusStopped)
+            INIStatsAdd(stats, Failures[code], 1);
+
+        return code;
+    }
+
+    while(stream->IOStreamCount > 0)
+    {
+        const char *newline = INIFindNewline(stream->IOStream, stream->IOStreamCount);
+
+        if(newline == NULL)
+        {
+            // The rest of the line arrives with the next chunk
+            Try(ListAddRange(lineBuffer, stream->IOStream, stream->IOStreamCount), INIStreamStatusFatalFailure);
+            stream->IOStream += stream->IOStreamCount;
+            stream->IOStreamCount = 0;
+            break;
+        }
+
+        const char *line = stream->IOStream;
+        size_t length = newline - line;
+
+        stream->IOStream += length + 1;
+        stream->IOStreamCount -= length + 1;
+
+        // Only lines that started in an earlier chunk are assembled in the line buffer, the rest are parsed in place
+        if(lineBuffer->Count > 0)
+        {
+            Try(ListAddRange(lineBuffer, line, length + 1), INIStreamStatusFatalFailure);
+            line = lineBuffer->V;
+            length = lineBuffer->Count - 1;
+        }
+
+        INIStatsAdd(stats, Lines, 1);
+        INIStatsAdd(stats, Bytes, length + 1);
+
+        int code = handlers != NULL ? INIReportLine(handlers, line, length) : INIParseLine(INI, stream, line, length);
+        ListClear(lineBuffer);
+
+        if(code != INIStreamStatusSuccess)
+        {
+            if(code > INIStreamStatusContinue && code < INIStreamStatusStopped)
+                INIStatsAdd(stats, Failures[code], 1);
+            return code;
+        }
+    }
+
+    return INIStreamStatusSuccess;
+}
+
+int INIStreamRead(INI *INI, INIStream *stream)
+{
+    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
+    Assert(stream, EINVAL, INIStreamStatusFatalFailure);
+    AssertMsg(INI->Frozen == NULL, EPERM, INIStreamStatusFatalFailure, FrozenMessage);
+
+    INIStatsStart(start);
+    int code = INIStreamLines(INI, stream, NULL);
+    INIStatsStop(INI->Stats, ParseSeconds, start);
+
+    return code;
+}
+
+int INIStreamParse(INIStream *stream, const INIHandlers *handlers)
+{
+    Assert(stream, EINVAL, INIStreamStatusFatalFailure);
+    Assert(handlers, EINVAL, INIStreamStatusFatalFailure);
+
+    return INIStreamLines(NULL, stream, handlers);
+}
+
+// A line is gathered as pieces pointing at the names, keys and values, which are copied straight into the output
+typedef struct INILinePiece
+{
+    const char *Data;
+    size_t Length;
+} INILinePiece;
+
+static int INIStreamWriteLines(INI *INI, INIStream *stream)
+{
+    ListChar *lineBuffer = (ListChar *)&stream->LineBuffer;
+    
+    while(1)
+    {
+        // The line buffer only holds a line that did not fit into the rest of the output
+        size_t pending = lineBuffer->Count - stream->LineBufferRead;
+        if(pending != 0)
+        {
+            size_t count = pending < stream->IOStreamCount ? pending : stream->IOStreamCount;
+            memcpy(stream->IOStream, lineBuffer->V + stream->LineBufferRead, count);
+
+            stream->IOStream += count;
+            stream->IOStreamCount -= count;
+            stream->LineBufferRead += count;
+
+            if(stream->LineBufferRead < lineBuffer->Count)
+                return INIStreamStatusContinue;
+        }
+
+        ListClear(lineBuffer);
+        stream->LineBufferRead = 0;
+
+        INILinePiece pieces[LinePieceCount];
+        size_t pieceCount = 0;
+        char number[INIFloatBufferSize];
+
+        if(stream->CurrentPair == NULL)
+        {
+            if(stream->CurrentSection == NULL)
+                stream->CurrentSection = INI->FirstSection;
+            else
+                stream->CurrentSection = INISectionAfter(INI, stream->CurrentSection);
+
+            if(stream->CurrentSection == NULL)
+                return INIStreamStatusSuccess;
+
+            // Handle writing section header
+
+            pieces[pieceCount++] = (INILinePiece){"[", 1};
+            pieces[pieceCount++] = (INILinePiece){stream->CurrentSection->Name, strlen(stream->CurrentSection->Name)};
+            pieces[pieceCount++] = (INILinePiece){"]", 1};
+
+            stream->CurrentPair = stream->CurrentSection->FirstPair;
+        }
+        else
+        {
+            // Handle writing pair info
+
+            INIPair *pair = stream->CurrentPair;
+            stream->CurrentPair = pair->NextPair;
+
+            pieces[pieceCount++] = (INILinePiece){pair->Key, strlen(pair->Key)};
+            pieces[pieceCount++] = (INILinePiece){" = ", 3};
+
+            switch(pair->Type)
+            {
+                case INITypeString:
+                {
+                    pieces[pieceCount++] = (INILinePiece){"\"", 1};
+                    pieces[pieceCount++] = (INILinePiece){pair->Value, strlen(pair->Value)};
+                    pieces[pieceCount++] = (INILinePiece){"\"", 1};
+                    break;
+                }
+                case INITypeFloat:
+                {
+                    // Whole numbers keep a fraction so they are read back as floats and not as integers
+                    INIDecodeValue(pair);
+                    pieces[pieceCount++] = (INILinePiece){number, INIFormatFloat(pair->Float, number)};
+                    break;
+                }
+                case INITypeInt:
+                {
+                    pieces[pieceCount++] = (INILinePiece){number, (size_t)snprintf(number, sizeof(number), "%" PRId64, pair->Int)};
+                    break;
+                }
+                case INITypeInvalid:
+                    return INIStreamStatusInvalidType;
+            }
+        }
+
+        pieces[pieceCount++] = (INILinePiece){"\n", 1};
+
+        size_t length = 0;
+        for(size_t x = 0; x < pieceCount; x++)
+            length += pieces[x].Length;
+
+        if(length <= stream->IOStreamCount)
+        {
+            for(size_t x = 0; x < pieceCount; x++)
+            {
+                memcpy(stream->IOStream, pieces[x].Data, pieces[x].Length);
+                stream->IOStream += pieces[x].Length;
+            }
+
+            stream->IOStreamCount -= length;
+            continue;
+        }
+
+        for(size_t x = 0; x < pieceCount; x++)
+            Try(ListAddRange(lineBuffer, pieces[x].Data, pieces[x].Length), INIStreamStatusFatalFailure);
+    }
+}
+
+int INIStreamWrite(INI *INI, INIStream *stream)
+{
+    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
+    Assert(stream, EINVAL, INIStreamStatusFatalFailure);
+
+    INIStatsStart(start);
+    int code = INIStreamWriteLines(INI, stream);
+    INIStatsStop(INI->Stats, WriteSeconds, start);
+
+    return code;
+}
+
+void INIStreamFree(INIStream *stream)
+{
+    ListFree(&stream->LineBuffer);
+}
+
+// Sections whose header failed to parse get these names instead, numbered in the order of the file
+void INIFallbackSectionName(char *name, size_t sectionParseFailCount)
+{
+    snprintf(name, FallbackNameSize, "ParseFailed_%zu", sectionParseFailCount);
+}
+
+// Feeds the current chunk of the stream to INIStreamRead, recovering from parse failures the way INIRead always has
+static int INIReadChunk(INI *INI, INIStream *stream, size_t *sectionParseFailCount)
+{
+    while(1)
+    {
+        int code = INIStreamRead(INI, stream);
+        switch(code)
+        {
+            case INIStreamStatusPairParseFailed:
+                continue;
+            case INIStreamStatusSectionHeaderParseFailed:
+            {
+                char fallbackSectionName[FallbackNameSize];
+                INIFallbackSectionName(fallbackSectionName, *sectionParseFailCount);
+                INISection *fallbackSection = INIAddSection(INI, fallbackSectionName);
+                if(fallbackSection != NULL)
+                    stream->CurrentSection = fallbackSection;
+                (*sectionParseFailCount)++;
+                continue;
+            }
+            default:
+                return code;
+        }
+    }
+}
+
+// Returns 1 for a record that does not make sense, which ends the log like a broken checksum
+static int INIJournalApply(INI *INI, char *body, size_t size)
+{
+    if(size < 3)
+        return 1;
+
+    char *end = body + size, *sectionName = body + 2, *key = NULL, *value = NULL;
+    char *sectionEnd = memchr(sectionName, '\0', end - sectionName);
+    if(sectionEnd == NULL)
+        return 1;
+
+    enum INIJournalKind kind = (unsigned char)body[0];
+    enum INIType type = (unsigned char)body[1];
+
+    if(kind == INIJournalSetValue || kind == INIJournalRemovePair)
+    {
+        key = sectionEnd + 1;
+        char *keyEnd = key < end ? memchr(key, '\0', end - key) : NULL;
+        if(keyEnd == NULL)
+            return 1;
+        value = keyEnd + 1;
+    }
+
+    INISection *section = INIFindSection(INI, sectionName);
+    INIPair *pair = section != NULL && key != NULL ? INIFindPair(section, key) : NULL;
+
+    switch(kind)
+    {
+        case INIJournalAddSection:
+            if(section == NULL)
+                TryNotNull(INIAddSection(INI, sectionName), -1);
+            return 0;
+        case INIJournalRemoveSection:
+            if(section != NULL)
+                Try(INIRemoveSection(INI, section), -1);
+            return 0;
+        case INIJournalRemovePair:
+            if(pair != NULL)
+                Try(INIRemovePair(section, pair), -1);
+            return 0;
+        case INIJournalSetValue:
+        {
+            int64_t number;
+            void *newValue = &number;
+            if(type == INITypeString && memchr(value, '\0', end - value) != NULL)
+                newValue = value;
+            else if((type == INITypeInt || type == INITypeFloat) && (size_t)(end - value) == sizeof(number))
+                memcpy(&number, value, sizeof(number));
+            else
+                return 1;
+
+            if(section == NULL)
+                TryNotNull(section = INIAddSection(INI, sectionName), -1);
+
+            if(pair != NULL)
+                Try(INISetValue(INI, pair, type, newValue), -1);
+            else
+                TryNotNull(INIAddValue(INI, section, key, type, newValue), -1);
+            return 0;
+        }
+        default:
+            return 1;
+    }
+}
+
+static int INIJournalTruncate(FILE *file, size_t size)
+{
+    Assert(fflush(file) == 0, errno, -1);
+#ifdef _WIN32
+    Assert(_chsize_s(_fileno(file), size) == 0, errno, -1);
+#else
+    Assert(ftruncate(fileno(file), size) == 0, errno, -1);
+#endif
+
+    return 0;
+}
+
+// Applies the records of the log to the INI and leaves the log positioned for the next record. 
+// Whatever follows the last whole record was cut short by a crash and is dropped
+static int INIJournalReplay(INI *INI, FILE *log)
+{
+    INIJournal *journal = INI->Journal;
+
+    INIJournalHeader header = {{0}, JournalVersion, BinaryByteOrder, 0};
+    memcpy(header.Magic, INIJournalMagic, sizeof(header.Magic));
+
+    Assert(fseek(log, 0, SEEK_END) == 0, errno, -1);
+    long size = ftell(log);
+    Assert(size >= 0, errno, -1);
+    rewind(log);
+
+    // A new log, or one whose header never made it to disk, is started over
+    if((size_t)size < sizeof(header))
+    {
+        AssertMsg(fwrite(&header, sizeof(header), 1, log) == 1, EIO, -1, "Cannot write the journal");
+        Try(INIJournalSyncFile(log), -1);
+        journal->LogSize = sizeof(header);
+        return 0;
+    }
+
+    char *data;
+    TryNotNull(data = malloc(size), -1);
+    AssertDo(fread(data, 1, size, log) == (size_t)size, EIO, free(data); return -1;);
+    AssertDo(memcmp(data, &header, sizeof(header)) == 0, EINVAL, free(data); return -1;);
+
+    size_t offset = sizeof(header);
+    int code = 0;
+    journal->Replaying = 1;
+
+    while(code == 0 && size - offset >= sizeof(INIJournalRecord))
+    {
+        INIJournalRecord record;
+        memcpy(&record, data + offset, sizeof(record));
+        char *body = data + offset + sizeof(record);
+
+        if(record.Size > size - offset - sizeof(record) || INIHash(body, record.Size) != record.Checksum)
+            break;
+
+        code = INIJournalApply(INI, body, record.Size);
+        if(code == 0)
+            offset += sizeof(record) + record.Size;
+    }
+
+    journal->Replaying = 0;
+    free(data);
+
+    if(code < 0)
+        return -1;
+
+    if(offset != (size_t)size)
+        Try(INIJournalTruncate(log, offset), -1);
+
+    Assert(fseek(log, offset, SEEK_SET) == 0, errno, -1);
+    journal->LogSize = offset;
+    return 0;
+}
+
+// The log is the file name with .journal appended, it is created if there is none
+static int INIJournalOpen(INI *INI, const char *fileName)
+{
+    INIJournal *journal = INI->Journal;
+    const char *extension = ".journal";
+
+    size_t length = strlen(fileName);
+    char *file, *logFile;
+    TryNotNull(file = malloc(length + 1), -1);
+    TryNotNull(logFile = malloc(length + strlen(extension) + 1), -1, free(file););
+    strcpy(file, fileName);
+    strcpy(logFile, fileName);
+    strcat(logFile, extension);
+
+    free(journal->File);
+    free(journal->LogFile);
+    journal->File = file;
+    journal->LogFile = logFile;
+
+    FILE *log = fopen(logFile, "r+b");
+    if(log == NULL && errno == ENOENT)
+        log = fopen(logFile, "w+b");
+    Assert(log != NULL, errno, -1);
+
+    Try(INIJournalReplay(INI, log), -1, fclose(log););
+    journal->Log = log;
+
+    return 0;
+}
+
+int INIRead(INI *INI, char *fileName)
+{
+    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
+    Assert(fileName, EINVAL, INIStreamStatusFatalFailure);
+
+    int retVal = INIStreamStatusSuccess;
+    INIStatsStart(start);
+
+    // The log of a file read before is left as it is
+    if(INI->Journal != NULL)
+        INIJournalClose(INI->Journal);
+
+    FILE *file = fopen(fileName, "r");
+    Assert(file != NULL, errno, INIStreamStatusFatalFailure);
+
+    char buffer[ReadBufferSize];
+    INIStream stream = INIStreamDefault;
+    size_t sectionParseFailCount = 0;
+
+    while(1)
+    {
+        size_t read = fread(buffer, sizeof(char), sizeof(buffer), file);
+        stream.IOStream = buffer;
+        stream.IOStreamCount = read; 
+
+        if(INIReadChunk(INI, &stream, &sectionParseFailCount) == INIStreamStatusFatalFailure)
+        {
+            retVal = INIStreamStatusFatalFailure;
+            break;
+        }
+
+        AssertDo(!ferror(file), ferror(file), retVal = INIStreamStatusFatalFailure; break;);
+
+        // The empty read at the end of the file has also flushed its last line
+        if(read == 0)
+            break;
+    }
+
+    fclose(file);
+    INIStreamFree(&stream);
+
+    if(retVal == INIStreamStatusSuccess && INI->Journal != NULL && INIJournalOpen(INI, fileName) != 0)
+        retVal = INIStreamStatusFatalFailure;
+
+    INIStatsStop(INI->Stats, ReadSeconds, start);
+
+    return retVal;
+}
+
+int INIReadBuffer(INI *INI, char *buffer, size_t size)
+{
+    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
+    Assert(buffer || size == 0, EINVAL, INIStreamStatusFatalFailure);
+    INIStatsStart(start);
+
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = buffer;
+    stream.IOStreamCount = size;
+
+    size_t sectionParseFailCount = 0;
+    int retVal = INIReadChunk(INI, &stream, &sectionParseFailCount);
+
+    // An empty chunk flushes a last line without a newline
+    if(retVal != INIStreamStatusFatalFailure)
+    {
+        stream.IOStreamCount = 0;
+        retVal = INIReadChunk(INI, &stream, &sectionParseFailCount);
+    }
+
+    INIStreamFree(&stream);
+    INIStatsStop(INI->Stats, ReadSeconds, start);
+    return retVal == INIStreamStatusFatalFailure ? retVal : INIStreamStatusSuccess;
+}
+
+int INIParse(char *fileName, const INIHandlers *handlers)
+{
+    Assert(fileName, EINVAL, INIStreamStatusFatalFailure);
+    Assert(handlers, EINVAL, INIStreamStatusFatalFailure);
+
+    FILE *file = fopen(fileName, "r");
+    Assert(file != NULL, errno, INIStreamStatusFatalFailure);
+
+    char buffer[ReadBufferSize];
+    INIStream stream = INIStreamDefault;
+    int retVal;
+
+    while(1)
+    {
+        size_t read = fread(buffer, sizeof(char), sizeof(buffer), file);
+        stream.IOStream = buffer;
+        stream.IOStreamCount = read;
+
+        retVal = INIStreamParse(&stream, handlers);
+        if(retVal != INIStreamStatusSuccess)
+            break;
+
+        AssertDo(!ferror(file), ferror(file), retVal = INIStreamStatusFatalFailure; break;);
+
+        if(read == 0)
+            break;
+    }
+
+    fclose(file);
+    INIStreamFree(&stream);
+    return retVal;
+}
+
+// Maps the file copy on write, so strings can be terminated in place without touching the file, empty files are not mapped
+static int INIMapFile(const char *fileName, char **data, size_t *size)
+{
+    *data = NULL;
+    *size = 0;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    Assert(file != INVALID_HANDLE_VALUE, EIO, -1);
+
+    LARGE_INTEGER fileSize;
+    AssertDo(GetFileSizeEx(file, &fileSize), EIO, CloseHandle(file); return -1;);
+
+    if(fileSize.QuadPart > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if(mapping != NULL)
+        {
+            *data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+
+        AssertDo(*data != NULL, EIO, CloseHandle(file); return -1;);
+        *size = (size_t)fileSize.QuadPart;
+    }
+
+    CloseHandle(file);
+#else
+    int file = open(fileName, O_RDONLY);
+    Assert(file >= 0, errno, -1);
+
+    struct stat status;
+    AssertDo(fstat(file, &status) == 0, errno, close(file); return -1;);
+
+    if(status.st_size > 0)
+    {
+        void *mapping = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        AssertDo(mapping != MAP_FAILED, errno, close(file); return -1;);
+
+        *data = mapping;
+        *size = status.st_size;
+    }
+
+    close(file);
+#endif
+
+    return 0;
+}
+
+static void INIUnmapFile(void *data, size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+static int INIAddMapping(INI *INI, char *data, size_t size)
+{
+    INIMapping *mapping;
+    TryNotNull(mapping = INIAllocate(INI, sizeof(*mapping)), -1);
+    mapping->Data = data;
+    mapping->Size = size;
+    mapping->PreviousMapping = INI->Mappings;
+    INI->Mappings = mapping;
+
+    return 0;
+}
+
+int INIReadMapped(INI *INI, char *fileName)
+{
+    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
+    Assert(fileName, EINVAL, INIStreamStatusFatalFailure);
+    INIStatsStart(start);
+
+    char *data;
+    size_t size;
+    Try(INIMapFile(fileName, &data, &size), INIStreamStatusFatalFailure);
+
+    if(data == NULL)
+        return INIStreamStatusSuccess;
+
+    Try(INIAddMapping(INI, data, size), INIStreamStatusFatalFailure, INIUnmapFile(data, size););
+
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = data;
+    stream.IOStreamCount = size;
+    stream.InPlaceBegin = data;
+    stream.InPlaceEnd = data + size;
+
+    size_t sectionParseFailCount = 0;
+    int retVal = INIReadChunk(INI, &stream, &sectionParseFailCount);
+
+    // Flushes a last line without a newline, which is copied as there is no room to terminate it in place
+    if(retVal != INIStreamStatusFatalFailure)
+        retVal = INIReadChunk(INI, &stream, &sectionParseFailCount);
+
+    INIStreamFree(&stream);
+    INIStatsStop(INI->Stats, ReadSeconds, start);
+    return retVal == INIStreamStatusFatalFailure ? retVal : INIStreamStatusSuccess;
+}
+
+// A part of the file starting at a section header, parsed into its own INI by one thread
+typedef struct INIParallelChunk
+{
+    INI INI;
+    struct INI *Target;
+    char *Data;
+    size_t Size;
+    // Collects the pairs before the first header, which belong to the last section the INI already had
+    INISection *Leading;
+    int HasLeading;
+    int Status;
+    size_t Moved;
+    // Counted on its own and added to the statistics of the target afterwards
+    INIStats Stats;
+} INIParallelChunk;
+
+// Stands in for a section whose header failed to parse, it is named or merged away when the chunks are joined
+static INISection *INIAddPlaceholderSection(INI *INI)
+{
+    INISection *section;
+    TryNotNull(section = INIAddLinkedListElement(INI, (void **)&INI->FirstSection, (void **)&INI->LastSection, sizeof(*section), offsetof(INISection, NextSection)), NULL);
+    section->Name = NULL;
+    section->FirstPair = NULL;
+    section->LastPair = NULL;
+    section->Owner = INI;
+
+    return section;
+}
+
+static int INIParseParallelChunk(INIParallelChunk *chunk)
+{
+    INI *INI = &chunk->INI;
+
+    // Duplicates within the chunk are found by the index, duplicates across chunks when they are joined
+    Try(INIEnableIndex(INI), INIStreamStatusFatalFailure);
+
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = chunk->Data;
+    stream.IOStreamCount = chunk->Size;
+    stream.InPlaceBegin = chunk->Data;
+    stream.InPlaceEnd = chunk->Data + chunk->Size;
+
+    if(chunk->HasLeading)
+        TryNotNull(stream.CurrentSection = chunk->Leading = INIAddPlaceholderSection(INI), INIStreamStatusFatalFailure);
+
+    int code = INIStreamStatusSuccess;
+    for(int flush = 0; flush < 2 && code != INIStreamStatusFatalFailure; flush++)
+    {
+        while(1)
+        {
+            code = INIStreamRead(INI, &stream);
+            if(code == INIStreamStatusPairParseFailed)
+                continue;
+
+            if(code != INIStreamStatusSectionHeaderParseFailed)
+                break;
+
+            if((stream.CurrentSection = INIAddPlaceholderSection(INI)) == NULL)
+            {
+                code = INIStreamStatusFatalFailure;
+                break;
             }
-            else if(*line == '\n' || *line == '#')
+        }
+    }
+
+    INIStreamFree(&stream);
+    return code;
+}
+
+static void *INIParseParallelChunkThread(void *argument)
+{
+    INIParallelChunk *chunk = argument;
+    chunk->Status = INIParseParallelChunk(chunk);
+
+    return NULL;
+}
+
+// Runs the function for every chunk, the first on the calling thread. Chunks whose thread could not be started run on it afterwards
+static int INIRunParallel(void *(*function)(void *), INIParallelChunk *chunks, size_t chunkCount)
+{
+    pthread_t *workers;
+    TryNotNull(workers = malloc(chunkCount * sizeof(*workers)), -1);
+
+    int *started;
+    TryNotNull(started = calloc(chunkCount, sizeof(*started)), -1, free(workers););
+
+    for(size_t x = 1; x < chunkCount; x++)
+        started[x] = pthread_create(workers + x, NULL, function, chunks + x) == 0;
+
+    for(size_t x = 0; x < chunkCount; x++)
+    {
+        if(started[x])
+            pthread_join(workers[x], NULL);
+        else
+            function(chunks + x);
+    }
+
+    free(started);
+    free(workers);
+    return 0;
+}
+
+// Moves the pair entries of a joined chunk into the index of its target, which has room for them already. 
+// The hashes were computed while parsing, and the threads of all chunks claim free slots atomically, so they can insert at the same time
+static void *INIMoveParallelEntriesThread(void *argument)
+{
+    INIParallelChunk *chunk = argument;
+    INITable *pairs = &chunk->INI.Index->Pairs, *targetPairs = &chunk->Target->Index->Pairs;
+    size_t mask = targetPairs->Capacity - 1;
+
+    for(size_t x = 0; x < pairs->Capacity; x++)
+    {
+        INIIndexEntry *entry = pairs->Entries + x;
+
+        // Pairs of sections that were merged away are indexed under the section they moved to already
+        if(entry->Element == NULL || entry->Element == &INIIndexTombstone || entry->Scope->Owner != chunk->Target)
+            continue;
+
+        for(size_t y = entry->Hash & mask;; y = (y + 1) & mask)
+        {
+            INIIndexEntry *slot = targetPairs->Entries + y;
+            void *expected = NULL;
+
+            if(atomic_compare_exchange_strong_explicit((_Atomic(void *) *)&slot->Element, &expected, entry->Element, memory_order_relaxed, memory_order_relaxed))
             {
-                ListClear(lineBuffer);
-                continue;
+                slot->Hash = entry->Hash;
+                slot->Scope = entry->Scope;
+                chunk->Moved++;
+                break;
             }
+        }
+    }
+
+    return NULL;
+}
+
+// Moves all blocks of another INI in front of the block the INI currently allocates from, which keeps its spare blocks last
+static void INIArenaAdopt(INI *INI, struct INI *other)
+{
+    INIArena *last = other->Arena;
+    if(last == NULL)
+        return;
+
+    INIArena *first = INIFirstArena(other);
+    INIArena *current = INI->Arena;
+    other->Arena = NULL;
+
+    if(current == NULL)
+    {
+        INI->Arena = last;
+        return;
+    }
+
+    first->PreviousArena = current->PreviousArena;
+    if(first->PreviousArena != NULL)
+        first->PreviousArena->NextArena = first;
+
+    last->NextArena = current;
+    current->PreviousArena = last;
+}
+
+// Appends the pairs of a section that does not make it into the INI to the given one, the way the sequential parser 
+// would have added them to its current section, keys already in use are dropped
+static int INIMergePairs(INI *INI, INISection *section, INISection *target)
+{
+    INIPair *pair = section->FirstPair;
+    section->FirstPair = NULL;
+    section->LastPair = NULL;
+
+    while(pair != NULL)
+    {
+        INIPair *nextPair = pair->NextPair;
+
+        // The target may still be missing from the index until its chunk is joined, so it is scanned
+        INIPair *existingPair = NULL;
+        for(INIPair *targetPair = target != NULL ? target->FirstPair : NULL; targetPair != NULL && existingPair == NULL; targetPair = targetPair->NextPair)
+        {
+            if(strcmp(targetPair->Key, pair->Key) == 0)
+                existingPair = targetPair;
+        }
+
+        if(target != NULL && existingPair == NULL)
+        {
+            pair->NextPair = NULL;
+            if(target->LastPair == NULL)
+                target->FirstPair = pair;
+            else
+                target->LastPair->NextPair = pair;
+            target->LastPair = pair;
+
+            if(INI->Index != NULL && target->Owner == INI)
+                Try(INIIndexAddPair(INI, target, pair), -1);
+        }
+
+        pair = nextPair;
+    }
+
+    return 0;
+}
+
+// Frozen sections of a clone are not in its index, so they are looked up in the frozen tables as well
+static int INIJoinedSectionExists(INI *INI, INITable *sections, const char *name, size_t length, uint32_t hash)
+{
+    return INITableFind(sections, hash, NULL, name, length, NULL) != NULL || (INI->Shared != NULL && INISharedFindSection(INI, name, length, hash) != NULL);
+}
+
+// Joins the sections of a chunk to the INI in order, giving duplicates and placeholders the names the sequential parser would have
+static int INIJoinParallelChunk(INI *INI, INIParallelChunk *chunk, struct INI *allocator, INITable *sections, size_t *sectionParseFailCount)
+{
+    INIArenaAdopt(INI, &chunk->INI);
+    Try(INITableReserve(allocator, sections, chunk->INI.Index->Sections.Count), INIStreamStatusFatalFailure);
+    INI->Version++;
+
+    INISection *section = chunk->INI.FirstSection;
+    chunk->INI.FirstSection = NULL;
+    chunk->INI.LastSection = NULL;
+
+    while(section != NULL)
+    {
+        INISection *nextSection = section->NextSection;
+        section->NextSection = NULL;
+
+        int merge = section == chunk->Leading;
+        size_t length = section->Name != NULL ? strlen(section->Name) : 0;
+        uint32_t hash = section->Name != NULL ? INIHash(section->Name, length) : 0;
+
+        if(!merge && (section->Name == NULL || INIJoinedSectionExists(INI, sections, section->Name, length, hash)))
+        {
+            char fallbackSectionName[FallbackNameSize];
+            INIFallbackSectionName(fallbackSectionName, (*sectionParseFailCount)++);
+
+            length = strlen(fallbackSectionName);
+            hash = INIHash(fallbackSectionName, length);
+            if(INIJoinedSectionExists(INI, sections, fallbackSectionName, length, hash))
+                merge = 1;
             else
+                TryNotNull(section->Name = INIStoreString(INI, fallbackSectionName, length), INIStreamStatusFatalFailure);
+        }
+
+        if(merge)
+        {
+            // Merged pairs are indexed on their own, the entries of the chunk scoped to this section are skipped
+            section->Owner = NULL;
+            Try(INIMergePairs(INI, section, INI->LastSection), INIStreamStatusFatalFailure);
+        }
+        else
+        {
+            section->Owner = INI;
+            INIAppendSection(INI, section);
+
+            Try(INITableInsert(allocator, sections, hash, NULL, section), INIStreamStatusFatalFailure);
+        }
+
+        section = nextSection;
+    }
+
+    return INIStreamStatusSuccess;
+}
+
+int INIReadParallel(INI *INI, char *fileName, int threads)
+{
+    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
+    Assert(fileName, EINVAL, INIStreamStatusFatalFailure);
+    Assert(threads > 0, EINVAL, INIStreamStatusFatalFailure);
+    AssertMsg(INI->Frozen == NULL, EPERM, INIStreamStatusFatalFailure, FrozenMessage);
+    INIStatsStart(start);
+
+    char *data;
+    size_t size;
+    Try(INIMapFile(fileName, &data, &size), INIStreamStatusFatalFailure);
+
+    if(data == NULL)
+        return INIStreamStatusSuccess;
+
+    Try(INIAddMapping(INI, data, size), INIStreamStatusFatalFailure, INIUnmapFile(data, size););
+
+    // Pairs before the first header are appended to the last section, which a clone needs a copy of
+    if(INI->LastSection != NULL)
+    {
+        TryNotNull(INIOwnSection(INI, INI->LastSection), INIStreamStatusFatalFailure);
+        Try(INIUnsharePairs(INI, INI->LastSection), INIStreamStatusFatalFailure);
+    }
+
+    if((size_t)threads > size / ParallelMinChunkSize)
+        threads = size / ParallelMinChunkSize > 0 ? (int)(size / ParallelMinChunkSize) : 1;
+
+    INIParallelChunk *chunks;
+    TryNotNull(chunks = calloc(threads, sizeof(*chunks)), INIStreamStatusFatalFailure);
+
+    // Chunks end right before a line that starts with '[', which is always parsed as a header and so never continues a section
+    size_t chunkCount = 0;
+    char *end = data + size;
+    for(char *begin = data; begin < end; chunkCount++)
+    {
+        char *split = chunkCount + 1 < (size_t)threads ? data + size / threads * (chunkCount + 1) : end;
+        if(split <= begin)
+            split = begin + 1;
+
+        while(split < end && !(split[-1] == '\n' && *split == '['))
+        {
+            char *newline = memchr(split, '\n', end - split);
+            split = newline == NULL ? end : newline + 1;
+        }
+
+        chunks[chunkCount] = (INIParallelChunk){.INI = INIDefault, .Target = INI, .Data = begin, .Size = split - begin, .HasLeading = begin == data && INI->LastSection != NULL};
+        chunks[chunkCount].INI.LazyValues = INI->LazyValues;
+        if(INI->Stats != NULL)
+            chunks[chunkCount].INI.Stats = &chunks[chunkCount].Stats;
+        begin = split;
+    }
+
+    Try(INIRunParallel(INIParseParallelChunkThread, chunks, chunkCount), INIStreamStatusFatalFailure, free(chunks););
+
+    // Without an index on the INI the sections are looked up in a table that only lives until the chunks are joined
+    struct INI lookup = INIDefault;
+    INITable lookupSections = {0};
+    INITable *sections = INI->Index != NULL ? &INI->Index->Sections : &lookupSections;
+    struct INI *allocator = INI->Index != NULL ? INI : &lookup;
+
+    int retVal = INIStreamStatusSuccess;
+    for(size_t x = 0; x < chunkCount; x++)
+    {
+        if(chunks[x].Status == INIStreamStatusFatalFailure)
+            retVal = INIStreamStatusFatalFailure;
+    }
+
+    if(INI->Index == NULL)
+    {
+        for(INISection *section = INI->FirstSection; section != NULL && retVal != INIStreamStatusFatalFailure; section = section->NextSection)
+        {
+            if(INITableInsert(&lookup, sections, INIHash(section->Name, strlen(section->Name)), NULL, section) != 0)
+                retVal = INIStreamStatusFatalFailure;
+        }
+    }
+
+    size_t sectionParseFailCount = 0;
+    for(size_t x = 0; x < chunkCount && retVal != INIStreamStatusFatalFailure; x++)
+        retVal = INIJoinParallelChunk(INI, chunks + x, allocator, sections, &sectionParseFailCount);
+
+    // The pairs go into the index of the INI last, once it is known which of their sections were kept
+    if(retVal != INIStreamStatusFatalFailure && INI->Index != NULL)
+    {
+        size_t pairCount = 0;
+        for(size_t x = 0; x < chunkCount; x++)
+            pairCount += chunks[x].INI.Index->Pairs.Count;
+
+        if(INITableReserve(INI, &INI->Index->Pairs, pairCount) != 0 || INIRunParallel(INIMoveParallelEntriesThread, chunks, chunkCount) != 0)
+            retVal = INIStreamStatusFatalFailure;
+
+        for(size_t x = 0; x < chunkCount; x++)
+        {
+            INI->Index->Pairs.Count += chunks[x].Moved;
+            INI->Index->Pairs.Used += chunks[x].Moved;
+        }
+    }
+
+    // Chunks do not share names with each other, so the names are interned once they are joined
+    if(retVal != INIStreamStatusFatalFailure && INI->Strings != NULL && INIInternAll(INI) != 0)
+        retVal = INIStreamStatusFatalFailure;
+
+    // Chunks that were not joined are dropped whole
+    for(size_t x = 0; x < chunkCount; x++)
+    {
+        if(INI->Stats != NULL)
+            INIStatsMerge(INI->Stats, &chunks[x].Stats);
+
+        chunks[x].INI.Stats = NULL;
+        INIFree(&chunks[x].INI);
+    }
+
+    INIFree(&lookup);
+    free(chunks);
+    INIStatsStop(INI->Stats, ReadSeconds, start);
+
+    return retVal;
+}
+
+int INIWrite(INI *INI, char *fileName)
+{
+    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
+    Assert(fileName, EINVAL, INIStreamStatusFatalFailure);
+
+    int retVal = INIStreamStatusSuccess;
+
+    FILE *file = fopen(fileName, "w");
+    Assert(file, errno, INIStreamStatusFatalFailure);
+
+    // Lines are written straight into one large buffer, which goes out in a single unbuffered write once it is full
+    char *buffer;
+    TryNotNull(buffer = malloc(WriteBufferSize), INIStreamStatusFatalFailure, fclose(file););
+    setvbuf(file, NULL, _IONBF, 0);
+
+    INIStream stream = INIStreamDefault;
+
+    while (1)
+    {
+        stream.IOStream = buffer;
+        stream.IOStreamCount = WriteBufferSize;
+
+        while (1)
+        {
+            int code = INIStreamWrite(INI, &stream);
+
+            switch(code)
             {
-                if(INI->FirstSection == NULL)
-                    goto FailPair;
+                case INIStreamStatusFatalFailure:
+                    retVal = INIStreamStatusFatalFailure;
+                    goto End;
+                case INIStreamStatusSuccess:
+                {
+                    fwrite(buffer, sizeof(char), WriteBufferSize - stream.IOStreamCount, file);
+                    AssertDo(!ferror(file), ferror(file), retVal = INIStreamStatusFatalFailure;);
+                    goto End;
+                }
+                case INIStreamStatusContinue:
+                    goto Continue;
+                case INIStreamStatusInvalidType:
+                    continue;
+            }
+        }
+
+        Continue:
+        
+        fwrite(buffer, sizeof(char), WriteBufferSize, file);
+        AssertDo(!ferror(file), ferror(file), retVal = INIStreamStatusFatalFailure; goto End;);
+    }
+
+    End:
+    fclose(file);
+    free(buffer);
+    INIStreamFree(&stream);
+    return retVal;
+}
+
+static int INIJournalSyncPath(const char *path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    Assert(file != INVALID_HANDLE_VALUE, EIO, -1);
+
+    BOOL flushed = FlushFileBuffers(file);
+    CloseHandle(file);
+    Assert(flushed, EIO, -1);
+#else
+    int file = open(path, O_RDONLY);
+    Assert(file >= 0, errno, -1);
+
+    int synced = fsync(file);
+    close(file);
+    Assert(synced == 0, errno, -1);
+#endif
+
+    return 0;
+}
+
+static int INIJournalReplace(const char *source, const char *target)
+{
+#ifdef _WIN32
+    Assert(MoveFileExA(source, target, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH), EIO, -1);
+#else
+    Assert(rename(source, target) == 0, errno, -1);
+
+    // The rename itself is only on disk once its directory is
+    char *directory;
+    TryNotNull(directory = malloc(strlen(target) + 2), -1);
+    strcpy(directory, target);
+
+    char *slash = strrchr(directory, '/');
+    if(slash == NULL)
+        strcpy(directory, ".");
+    else
+        slash[slash == directory] = '\0';
+
+    int synced = INIJournalSyncPath(directory);
+    free(directory);
+    Try(synced, -1);
+#endif
+
+    return 0;
+}
+
+int INIJournalCompact(INI *INI)
+{
+    Assert(INI, EINVAL, -1);
+    INIJournal *journal = INI->Journal;
+    AssertMsg(journal != NULL && journal->Log != NULL, EINVAL, -1, NoJournalMessage);
+
+    const char *extension = ".tmp";
+    char *temporary;
+    TryNotNull(temporary = malloc(strlen(journal->File) + strlen(extension) + 1), -1);
+    strcpy(temporary, journal->File);
+    strcat(temporary, extension);
+
+    // The new file only replaces the old one once all of it is on disk, so a crash leaves one of them whole. 
+    // A crash before the log is emptied replays changes the file has already, which ends in the same INI
+    Try(INIWrite(INI, temporary), -1, remove(temporary); free(temporary););
+    Try(INIJournalSyncPath(temporary), -1, remove(temporary); free(temporary););
+    Try(INIJournalReplace(temporary, journal->File), -1, remove(temporary); free(temporary););
+    free(temporary);
+
+    Try(INIJournalTruncate(journal->Log, sizeof(INIJournalHeader)), -1);
+    Assert(fseek(journal->Log, sizeof(INIJournalHeader), SEEK_SET) == 0, errno, -1);
+    Try(INIJournalSyncFile(journal->Log), -1);
+    journal->LogSize = sizeof(INIJournalHeader);
+
+    return 0;
+}
+
+uint64_t INIChecksum(const char *data, size_t size)
+{
+    const uint64_t multiplier = 0x9E3779B97F4A7C15u;
+    uint64_t hash = size;
+
+    size_t x = 0;
+    for(; x + sizeof(uint64_t) <= size; x += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, data + x, sizeof(word));
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+
+    for(; x < size; x++)
+    {
+        hash = (hash ^ (unsigned char)data[x]) * multiplier;
+        hash ^= hash >> 29;
+    }
+
+    return hash;
+}
+
+static int INISourceStatus(const char *sourceFile, int64_t *time, uint64_t *size)
+{
+    struct stat status;
+    Assert(stat(sourceFile, &status) == 0, errno, -1);
+
+    *time = (int64_t)status.st_mtime;
+    *size = (uint64_t)status.st_size;
+    return 0;
+}
+
+static int INISourceHash(const char *sourceFile, uint64_t *hash)
+{
+    char *data;
+    size_t size;
+    Try(INIMapFile(sourceFile, &data, &size), -1);
+
+    *hash = INIChecksum(data, size);
+    if(data != NULL)
+        INIUnmapFile(data, size);
+
+    return 0;
+}
+
+static size_t INIBinaryAlign(size_t offset)
+{
+    return (offset + BinaryAlignment - 1) & ~(size_t)(BinaryAlignment - 1);
+}
+
+static void *INIBinaryOffset(size_t offset)
+{
+    return (void *)(uintptr_t)offset;
+}
+
+static void *INIBinaryStoreString(char *image, size_t *offset, const char *string)
+{
+    size_t length = strlen(string) + 1;
+    memcpy(image + *offset, string, length);
+    *offset += length;
+
+    return INIBinaryOffset(*offset - length);
+}
+
+int INISaveBinary(INI *INI, char *fileName, char *sourceFile)
+{
+    Assert(INI, EINVAL, -1);
+    Assert(fileName, EINVAL, -1);
+
+    INIBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, INIBinaryMagic, sizeof(header.Magic));
+    header.Version = BinaryVersion;
+    header.ByteOrder = BinaryByteOrder;
+    header.PointerSize = sizeof(void *);
+    header.SectionSize = sizeof(INISection);
+    header.PairSize = sizeof(INIPair);
+
+    if(sourceFile != NULL)
+    {
+        Try(INISourceStatus(sourceFile, &header.SourceTime, &header.SourceSize), -1);
+        Try(INISourceHash(sourceFile, &header.SourceHash), -1);
+    }
+
+    // Sizes the image first, so it is built in one allocation and written at once
+    size_t stringsSize = 0;
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section))
+    {
+        header.SectionCount++;
+        stringsSize += strlen(section->Name) + 1;
+
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+        {
+            header.PairCount++;
+            stringsSize += strlen(pair->Key) + 1;
+            if(pair->Type == INITypeString)
+                stringsSize += strlen(pair->Value) + 1;
+        }
+    }
+
+    header.SectionsOffset = INIBinaryAlign(sizeof(header));
+    header.PairsOffset = INIBinaryAlign(header.SectionsOffset + header.SectionCount * sizeof(INISection));
+    header.StringsOffset = header.PairsOffset + header.PairCount * sizeof(INIPair);
+    header.Size = header.StringsOffset + stringsSize;
+
+    char *image;
+    TryNotNull(image = calloc(1, header.Size), -1);
+
+    INISection *sections = (INISection *)(image + header.SectionsOffset);
+    INIPair *pairs = (INIPair *)(image + header.PairsOffset);
+    size_t stringOffset = header.StringsOffset;
+    size_t sectionCount = 0, pairCount = 0;
+
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section), sectionCount++)
+    {
+        INISection *record = sections + sectionCount;
+        record->Name = INIBinaryStoreString(image, &stringOffset, section->Name);
+
+        if(sectionCount + 1 < header.SectionCount)
+            record->NextSection = INIBinaryOffset(header.SectionsOffset + (sectionCount + 1) * sizeof(INISection));
+
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair, pairCount++)
+        {
+            INIPair *pairRecord = pairs + pairCount;
+            size_t recordOffset = header.PairsOffset + pairCount * sizeof(INIPair);
+
+            if(pair == section->FirstPair)
+                record->FirstPair = INIBinaryOffset(recordOffset);
+            if(pair->NextPair == NULL)
+                record->LastPair = INIBinaryOffset(recordOffset);
+            else
+                pairRecord->NextPair = INIBinaryOffset(recordOffset + sizeof(INIPair));
+
+            INIDecodeValue(pair);
+            pairRecord->Key = INIBinaryStoreString(image, &stringOffset, pair->Key);
+            pairRecord->Type = pair->Type;
+
+            if(pair->Type == INITypeString)
+                pairRecord->Value = INIBinaryStoreString(image, &stringOffset, pair->Value);
+            else if(pair->Type == INITypeInt)
+                pairRecord->Int = pair->Int;
+            else if(pair->Type == INITypeFloat)
+                pairRecord->Float = pair->Float;
+        }
+    }
+
+    header.Checksum = INIChecksum(image + sizeof(header), header.Size - sizeof(header));
+    memcpy(image, &header, sizeof(header));
+
+    FILE *file = fopen(fileName, "wb");
+    AssertDo(file != NULL, errno, free(image); return -1;);
+
+    size_t written = fwrite(image, 1, header.Size, file);
+    int closed = fclose(file);
+    free(image);
+
+    Assert(written == header.Size && closed == 0, EIO, -1);
+    return 0;
+}
+
+// Checks an offset read from an image, which has to point at a whole record or string inside of its table
+static int INIBinaryValidOffset(const INIBinaryHeader *header, const void *pointer, uint64_t begin, uint64_t end, size_t recordSize)
+{
+    uintptr_t offset = (uintptr_t)pointer;
+    if(offset == 0)
+        return 1;
+
+    return offset >= begin && offset < end && (recordSize == 0 || (offset - begin) % recordSize == 0) && end <= header->Size;
+}
+
+static void *INIBinaryResolve(char *data, const void *pointer)
+{
+    return pointer == NULL ? NULL : data + (uintptr_t)pointer;
+}
+
+// Turns the offsets of a valid image into pointers, the mapping is private so this never reaches the file
+static int INIBinaryAttach(INI *INI, char *data, size_t size, const char *sourceFile)
+{
+    INIBinaryHeader header;
+    if(size < sizeof(header))
+        return -1;
+
+    memcpy(&header, data, sizeof(header));
+    if(memcmp(header.Magic, INIBinaryMagic, sizeof(header.Magic)) != 0 || header.Version != BinaryVersion || header.ByteOrder != BinaryByteOrder ||
+        header.PointerSize != sizeof(void *) || header.SectionSize != sizeof(INISection) || header.PairSize != sizeof(INIPair) || header.Size != size)
+        return -1;
+
+    uint64_t sectionsEnd = header.SectionsOffset + header.SectionCount * sizeof(INISection);
+    uint64_t pairsEnd = header.PairsOffset + header.PairCount * sizeof(INIPair);
+    if(header.SectionsOffset < sizeof(header) || header.SectionsOffset % BinaryAlignment != 0 || header.PairsOffset % BinaryAlignment != 0 ||
+        sectionsEnd > header.PairsOffset || pairsEnd > header.StringsOffset || header.StringsOffset > size || 
+        (header.StringsOffset < size && data[size - 1] != '\0'))
+        return -1;
+
+    // Stale when the source changed, an unchanged modification time and size are trusted without hashing the source
+    if(sourceFile != NULL)
+    {
+        int64_t time;
+        uint64_t sourceSize, hash;
+        if(INISourceStatus(sourceFile, &time, &sourceSize) != 0 || sourceSize != header.SourceSize)
+            return -1;
+        if(time != header.SourceTime && (INISourceHash(sourceFile, &hash) != 0 || hash != header.SourceHash))
+            return -1;
+    }
+
+    if(INIChecksum(data + sizeof(header), size - sizeof(header)) != header.Checksum)
+        return -1;
+
+    INISection *sections = (INISection *)(data + header.SectionsOffset);
+    INIPair *pairs = (INIPair *)(data + header.PairsOffset);
+
+    for(uint64_t x = 0; x < header.PairCount; x++)
+    {
+        INIPair *pair = pairs + x;
+        if(!INIBinaryValidOffset(&header, pair->Key, header.StringsOffset, size, 0) || pair->Key == NULL || !INIBinaryValidOffset(&header, pair->NextPair, header.PairsOffset, pairsEnd, sizeof(INIPair)) ||
+            (pair->Type == INITypeString && (pair->Value == NULL || !INIBinaryValidOffset(&header, pair->Value, header.StringsOffset, size, 0))))
+            return -1;
+    }
+
+    for(uint64_t x = 0; x < header.SectionCount; x++)
+    {
+        INISection *section = sections + x;
+        if(!INIBinaryValidOffset(&header, section->Name, header.StringsOffset, size, 0) || section->Name == NULL || 
+            !INIBinaryValidOffset(&header, section->FirstPair, header.PairsOffset, pairsEnd, sizeof(INIPair)) ||
+            !INIBinaryValidOffset(&header, section->LastPair, header.PairsOffset, pairsEnd, sizeof(INIPair)) ||
+            !INIBinaryValidOffset(&header, section->NextSection, header.SectionsOffset, sectionsEnd, sizeof(INISection)))
+            return -1;
+    }
+
+    for(uint64_t x = 0; x < header.PairCount; x++)
+    {
+        INIPair *pair = pairs + x;
+        pair->Key = INIBinaryResolve(data, pair->Key);
+        pair->NextPair = INIBinaryResolve(data, pair->NextPair);
+        pair->RawLength = 0;
+        if(pair->Type == INITypeString)
+            pair->Value = INIBinaryResolve(data, pair->Value);
+    }
+
+    for(uint64_t x = 0; x < header.SectionCount; x++)
+    {
+        INISection *section = sections + x;
+        section->Name = INIBinaryResolve(data, section->Name);
+        section->FirstPair = INIBinaryResolve(data, section->FirstPair);
+        section->LastPair = INIBinaryResolve(data, section->LastPair);
+        section->NextSection = INIBinaryResolve(data, section->NextSection);
+        section->Owner = INI;
+    }
+
+    if(header.SectionCount != 0)
+    {
+        INI->FirstSection = sections;
+        INI->LastSection = sections + header.SectionCount - 1;
+    }
+
+    INI->Version++;
+
+    return 0;
+}
 
-                char *key = StripLeadingWhitespace(line);
-                while(*line != '=')
+int INILoadBinary(INI *INI, char *fileName, char *sourceFile)
+{
+    Assert(INI, EINVAL, -1);
+    Assert(fileName, EINVAL, -1);
+    AssertMsg(INI->FirstSection == NULL, EINVAL, -1, "Binary INIs can only be loaded into an empty INI");
+    AssertMsg(INI->Frozen == NULL, EPERM, -1, FrozenMessage);
+    INIStatsStart(start);
+
+    char *data;
+    size_t size;
+    if(INIMapFile(fileName, &data, &size) == 0 && data != NULL)
+    {
+        if(INIBinaryAttach(INI, data, size, sourceFile) == 0)
+        {
+            Try(INIAddMapping(INI, data, size), -1, INIUnmapFile(data, size); INI->FirstSection = NULL; INI->LastSection = NULL;);
+
+            if(INI->Index != NULL)
+            {
+                for(INISection *section = INI->FirstSection; section != NULL; section = section->NextSection)
                 {
-                    if(*line == '\n' || *line == '\0')
-                        goto FailPair;
+                    Try(INIIndexAddSection(INI, section), -1);
 
-                    line++;
+                    for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+                        Try(INIIndexAddPair(INI, section, pair), -1);
                 }
+            }
 
-                *line = '\0';
-                StripEndingWhitespace(key);
+            if(INI->Strings != NULL)
+                Try(INIInternAll(INI), -1);
 
-                line++;
-                char *value = StripLeadingWhitespace(line);
+            INIStatsStop(INI->Stats, ReadSeconds, start);
+            return 0;
+        }
 
-                while(*line != '\n' && *line != '\0')
-                    line++;
+        INIUnmapFile(data, size);
+    }
 
-                *line = '\0';
-                StripEndingWhitespace(value);
+    AssertMsg(sourceFile != NULL, EINVAL, -1, "Binary INI is missing, stale or corrupt");
+    Try(INIRead(INI, sourceFile), -1);
+    return 1;
+}
 
-                INISection *section = INI->FirstSection;
-                while(section != NULL && section->NextSection != NULL)
-                    section = section->NextSection;
 
-                INIPair *pair;
-                TryNotNull(pair = INIAddPair(INI, section, key), INIStreamStatusFatalFailure,
-                    if(errno == EINVAL)
-                        goto FailPair;
-                );
+static void INIUnmapAll(INI *INI)
+{
+    for(INIMapping *mapping = INI->Mappings; mapping != NULL; mapping = mapping->PreviousMapping)
+        INIUnmapFile(mapping->Data, mapping->Size);
 
-                switch(value[0])
-                {
-                    case '"':
-                    {
-                        value++;
-                        size_t valueLength = strlen(value);
-                        if(value[valueLength - 1] != '"')
-                            goto FailPair;
-                        value[valueLength - 1] = '\0';
-                        Try(INISetString(INI, pair, value), INIStreamStatusFatalFailure);
-                        break;
-                    }
-                    default:
-                    {
-                        double valueFloat = strtod(value, NULL);
-                        Try(INISetFloat(INI, pair, valueFloat), INIStreamStatusFatalFailure);
-                        break;
-                    }
-                }
+    INI->Mappings = NULL;
+}
 
-                ListClear(lineBuffer);
-                continue;
+// Frees the blocks from the given one on, except for buffers given by INIUseBuffer
+static void INIArenaFree(INIArena *arena)
+{
+    while(arena != NULL)
+    {
+        INIArena *temp = arena;
+        arena = arena->NextArena;
 
-                FailPair:
-                ListClear(lineBuffer);
-                Throw(EINVAL, INIStreamStatusPairParseFailed, "INI stream failed to parse pair");
-            }
-        }
+        if(!temp->External)
+            free(temp);
+    }
+}
 
-        if(stream->IOStreamCount == 0)
-            break;
+// Makes all blocks empty again, everything that was allocated from them has to be dropped
+static void INIArenaRewind(INI *INI)
+{
+    INIArena *arena = INIFirstArena(INI);
+    INI->Arena = arena;
+
+    for(; arena != NULL; arena = arena->NextArena)
+        arena->Used = INIArenaHeaderSize();
+}
+
+// Keeps only the first block, empty, and frees the others, which INIAllocateAligned would otherwise keep as spares
+static void INIArenaTrim(INI *INI)
+{
+    INIArena *arena = INIFirstArena(INI);
+    INI->Arena = arena;
+
+    if(arena == NULL)
+        return;
+
+    INIArenaFree(arena->NextArena);
+    arena->NextArena = NULL;
+    arena->Used = INIArenaHeaderSize();
+}
+
+static char *INIFreezeString(char **strings, const char *string)
+{
+    char *frozenString = *strings;
+    size_t length = strlen(string) + 1;
+    memcpy(frozenString, string, length);
+    *strings += length;
+
+    return frozenString;
+}
+
+// Fills the tree in order, which turns sorted entries into Eytzinger order
+static size_t INIFrozenEytzinger(const INIFrozenEntry *sorted, INIFrozenEntry *tree, size_t count, size_t next, size_t position)
+{
+    if(position > count)
+        return next;
+
+    next = INIFrozenEytzinger(sorted, tree, count, next, 2 * position);
+    tree[position] = sorted[next++];
+    return INIFrozenEytzinger(sorted, tree, count, next, 2 * position + 1);
+}
 
-        char curChar = *stream->IOStream;
-        Try(ListAdd(lineBuffer, &curChar), INIStreamStatusFatalFailure);
+static int INIFrozenEntryCompare(const void *a, const void *b)
+{
+    const INIFrozenEntry *first = a, *second = b;
+    if(first->Hash != second->Hash)
+        return first->Hash < second->Hash ? -1 : 1;
+
+    return (first->Index > second->Index) - (first->Index < second->Index);
+}
+
+static size_t INIFrozenSectionSize(INISection *section)
+{
+    size_t pairCount = 0, size = sizeof(INISection) + strlen(section->Name) + 1;
 
-        stream->IOStream++;
-        stream->IOStreamCount--;
+    for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair, pairCount++)
+    {
+        size += sizeof(INIPair) + strlen(pair->Key) + 1;
+        if(pair->Type == INITypeString)
+            size += strlen(pair->Value) + 1;
     }
 
-    return INIStreamStatusSuccess;
+    if(pairCount > FrozenLinearSearchMax)
+        size += pairCount * sizeof(INIFrozenEntry);
+
+    return INIAlign(size, FrozenAlignment);
 }
 
-int INIStreamWrite(INI *INI, INIStream *stream)
+// Copies the section with its pairs, their entries and strings to the start of the block and returns where the next section starts
+static char *INIFreezeSection(INI *owner, INISection *section, char *block)
 {
-    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
-    Assert(stream, EINVAL, INIStreamStatusFatalFailure);
+    size_t pairCount = 0;
+    for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+        pairCount++;
 
-    ListChar *lineBuffer = (ListChar *)&stream->LineBuffer;
-    
-    while(1)
+    INISection *frozenSection = (INISection *)block;
+    INIPair *frozenPairs = (INIPair *)(frozenSection + 1);
+    INIFrozenEntry *entries = (INIFrozenEntry *)(frozenPairs + pairCount);
+    char *strings = (char *)(pairCount > FrozenLinearSearchMax ? entries + pairCount : entries);
+
+    frozenSection->Name = INIFreezeString(&strings, section->Name);
+    frozenSection->FirstPair = pairCount != 0 ? frozenPairs : NULL;
+    frozenSection->LastPair = pairCount != 0 ? frozenPairs + pairCount - 1 : NULL;
+    frozenSection->NextSection = NULL;
+    frozenSection->Owner = owner;
+
+    uint32_t pairIndex = 0;
+    for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair, pairIndex++)
     {
-        for(; stream->LineBufferRead < lineBuffer->Count; stream->LineBufferRead++)
-        {
-            if(stream->IOStreamCount == 0)
-                return INIStreamStatusContinue;
+        // Lazy floats are converted in the copy, as their text may be in the arena that is rewound
+        INIPair *frozenPair = frozenPairs + pairIndex;
+        *frozenPair = *pair;
+        INIDecodeValue(frozenPair);
+        frozenPair->Key = INIFreezeString(&strings, pair->Key);
+        if(pair->Type == INITypeString)
+            frozenPair->Value = INIFreezeString(&strings, pair->Value);
+        frozenPair->NextPair = pair->NextPair != NULL ? frozenPair + 1 : NULL;
+
+        if(pairCount > FrozenLinearSearchMax)
+            entries[pairIndex] = (INIFrozenEntry){INIHash(pair->Key, strlen(pair->Key)), pairIndex};
+    }
 
-            *stream->IOStream = lineBuffer->V[stream->LineBufferRead];
+    if(pairCount > FrozenLinearSearchMax)
+        qsort(entries, pairCount, sizeof(INIFrozenEntry), INIFrozenEntryCompare);
 
-            stream->IOStream++;
-            stream->IOStreamCount--;
-        }
+    return block + INIAlign(strings - block, FrozenAlignment);
+}
 
-        ListClear(lineBuffer);
+// Builds the frozen copy of the INI without changing it, so the INI may be read by others meanwhile
+static INIFrozen *INIFrozenBuild(INI *INI)
+{
+    size_t sectionCount = 0, sectionsSize = 0;
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section), sectionCount++)
+        sectionsSize += INIFrozenSectionSize(section);
+
+    AssertMsg(sectionCount < UINT32_MAX && sectionsSize / FrozenAlignment < UINT32_MAX, EOVERFLOW, NULL, "INI is too large to be frozen");
+
+    size_t entriesOffset = INIAlign(sizeof(INIFrozen), _Alignof(INIFrozenEntry));
+    size_t offsetsOffset = entriesOffset + (sectionCount + 1) * sizeof(INIFrozenEntry);
+    size_t blockOffset = INIAlign(offsetsOffset + sectionCount * sizeof(uint32_t), FrozenAlignment);
+
+    char *memory;
+    INIFrozenEntry *sortedSections;
+    TryNotNull(memory = malloc(blockOffset + sectionsSize), NULL);
+    TryNotNull(sortedSections = malloc((sectionCount + 1) * sizeof(*sortedSections)), NULL, free(memory););
+
+    INIFrozen *frozen = (INIFrozen *)memory;
+    frozen->Block = memory + blockOffset;
+    frozen->Size = sectionsSize;
+    frozen->SectionEntries = (INIFrozenEntry *)(memory + entriesOffset);
+    frozen->SectionOffsets = (uint32_t *)(memory + offsetsOffset);
+    frozen->SectionCount = sectionCount;
+    atomic_init(&frozen->References, 1);
+    frozen->Owner = INIDefault;
+    frozen->Owner.Frozen = frozen;
+
+    char *next = frozen->Block;
+    INISection *previous = NULL;
+    uint32_t sectionIndex = 0;
+
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section), sectionIndex++)
+    {
+        INISection *frozenSection = (INISection *)next;
+        next = INIFreezeSection(&frozen->Owner, section, next);
 
-        if(stream->CurrentPair == NULL)
-        {
-            if(stream->CurrentSection == NULL)
-                stream->CurrentSection = INI->FirstSection;
-            else
-                stream->CurrentSection = stream->CurrentSection->NextSection;
+        if(previous != NULL)
+            previous->NextSection = frozenSection;
+        previous = frozenSection;
 
-            if(stream->CurrentSection == NULL)
-                return INIStreamStatusSuccess;
+        uint32_t offset = (uint32_t)(((char *)frozenSection - frozen->Block) / FrozenAlignment);
+        sortedSections[sectionIndex] = (INIFrozenEntry){INIHash(section->Name, strlen(section->Name)), offset};
+        frozen->SectionOffsets[sectionIndex] = offset;
+    }
 
-            // Handle writing section header
+    qsort(sortedSections, sectionCount, sizeof(INIFrozenEntry), INIFrozenEntryCompare);
+    INIFrozenEytzinger(sortedSections, frozen->SectionEntries, sectionCount, 0, 1);
+    free(sortedSections);
 
-            const char headerBegin = '[', headerEnd = ']';
+    return frozen;
+}
 
-            Try(ListAdd(lineBuffer, &headerBegin), INIStreamStatusFatalFailure);
-            Try(ListAddRange(lineBuffer, stream->CurrentSection->Name, strlen(stream->CurrentSection->Name)), INIStreamStatusFatalFailure);
-            Try(ListAdd(lineBuffer, &headerEnd), INIStreamStatusFatalFailure);
+int INIFreeze(INI *INI)
+{
+    Assert(INI, EINVAL, -1);
 
-            stream->CurrentPair = stream->CurrentSection->FirstPair;
-        }
-        else
-        {
-            // Handle writing pair info
+    if(INI->Frozen != NULL)
+        return 0;
 
-            const char separator[] = " = ";
+    INIFrozen *frozen;
+    TryNotNull(frozen = INIFrozenBuild(INI), -1);
 
-            Try(ListAddRange(lineBuffer, stream->CurrentPair->Key, strlen(stream->CurrentPair->Key)), INIStreamStatusFatalFailure);
-            Try(ListAddRange(lineBuffer, separator, sizeof(separator) - 1), INIStreamStatusFatalFailure);
+    // Nothing points into the old nodes, mappings and index anymore
+    INIUnmapAll(INI);
+    INIArenaTrim(INI);
 
-            switch(stream->CurrentPair->Type)
-            {
-                case INITypeString:
-                {
-                    char quote = '"';
-                    Try(ListAdd(lineBuffer, &quote), INIStreamStatusFatalFailure);
-                    Try(ListAddRange(lineBuffer, stream->CurrentPair->Value, strlen(stream->CurrentPair->Value)), INIStreamStatusFatalFailure);
-                    Try(ListAdd(lineBuffer, &quote), INIStreamStatusFatalFailure);
-                    break;
-                }
-                case INITypeFloat:
-                {
-                    char buffer[256];
-                    snprintf(buffer, sizeof(buffer), "%g", *(double *)stream->CurrentPair->Value);
-                    Try(ListAddRange(lineBuffer, buffer, strlen(buffer)), INIStreamStatusFatalFailure);
-                    break;
-                }
-                case INITypeInvalid:
-                {
-                    stream->CurrentPair = stream->CurrentPair->NextPair;
-                    stream->LineBufferRead = 0;
-                    return INIStreamStatusInvalidType;
-                    break;
-                }
-            }
+    INI->Index = NULL;
+    INI->Strings = NULL;
+    INI->Frozen = frozen;
+    INISharedRelease(INI);
 
-            stream->CurrentPair = stream->CurrentPair->NextPair;
-        }
+    // Nothing can change anymore, the pairs have moved as well
+    if(INI->Journal != NULL)
+    {
+        INIJournalClose(INI->Journal);
+        memset(&INI->Journal->Pairs, 0, sizeof(INI->Journal->Pairs));
+    }
+    INI->FirstSection = frozen->SectionCount != 0 ? INIFrozenSection(frozen, 0) : NULL;
+    INI->LastSection = frozen->SectionCount != 0 ? INIFrozenSection(frozen, frozen->SectionCount - 1) : NULL;
+    INI->Version++;
 
-        const char newline = '\n';
-        Try(ListAdd(lineBuffer, &newline), INIStreamStatusFatalFailure);
-        stream->LineBufferRead = 0;
+    return 0;
+}
+
+// Copies what the source, another clone, has of its own, which are the nodes that replace or remove frozen sections and 
+// the added sections. Pairs are shared as long as the source shares them, those the source has changed are copied with their strings
+static int INICloneSections(INI *INI, struct INI *source)
+{
+    INIShared *shared = INI->Shared;
+    INITable *copies = &source->Shared->Copies;
+    Try(INITableReserve(INI, &shared->Copies, copies->Count), -1);
+
+    for(size_t x = 0; x < copies->Capacity; x++)
+    {
+        INIIndexEntry *entry = copies->Entries + x;
+        if(entry->Element == NULL || entry->Element == &INIIndexTombstone)
+            continue;
+
+        INISection *section = entry->Element, *copy;
+        TryNotNull(copy = INIAllocate(INI, sizeof(*copy)), -1);
+        *copy = *section;
+        copy->Owner = section->Owner == source ? INI : NULL;
+        Try(INITableInsert(INI, &shared->Copies, entry->Hash, entry->Scope, copy), -1);
+
+        if(copy->Owner == NULL || INIIsShared(INI, section->FirstPair))
+            continue;
+
+        copy->FirstPair = NULL;
+        copy->LastPair = NULL;
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            TryNotNull(INICopyPair(INI, copy, pair), -1);
     }
+
+    for(INISection *section = source->Shared->FirstAdded; section != NULL; section = section->NextSection)
+    {
+        INISection *copy;
+        TryNotNull(copy = INIAllocate(INI, sizeof(*copy)), -1);
+        TryNotNull(copy->Name = INIStoreString(INI, section->Name, strlen(section->Name)), -1);
+        copy->FirstPair = NULL;
+        copy->LastPair = NULL;
+        copy->Owner = INI;
+        INIAppendSection(INI, copy);
+        Try(INIIndexAddSection(INI, copy), -1);
+
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            TryNotNull(INICopyPair(INI, copy, pair), -1);
+    }
+
+    return 0;
 }
 
-void INIStreamFree(INIStream *stream)
+int INIClone(INI *INI, struct INI *clone)
 {
-    ListFree(&stream->LineBuffer);
+    Assert(INI, EINVAL, -1);
+    Assert(clone, EINVAL, -1);
+    Assert(INI != clone, EINVAL, -1);
+
+    // Frozen contents are shared as nothing writes to them, any other INI is frozen into contents only the clone has. 
+    // The INI is only read either way, so it may be cloned by several threads at once
+    INIFrozen *frozen = INI->Frozen != NULL ? INI->Frozen : INI->Shared != NULL ? INI->Shared->Frozen : NULL;
+    if(frozen != NULL)
+        atomic_fetch_add(&frozen->References, 1);
+    else
+        TryNotNull(frozen = INIFrozenBuild(INI), -1);
+
+    INIShared *shared;
+    TryNotNull(shared = malloc(sizeof(*shared)), -1, INIFrozenRelease(frozen););
+    *shared = (INIShared){.Frozen = frozen, .Copies = {0}, .FirstAdded = NULL, .LastAdded = NULL};
+
+    *clone = INIDefault;
+    clone->LazyValues = INI->LazyValues;
+    clone->Shared = shared;
+    Try(INIEnableIndex(clone), -1, INIFree(clone););
+
+    if(INI->Shared != NULL)
+        Try(INICloneSections(clone, INI), -1, INIFree(clone););
+
+    INISharedEnds(clone);
+    return 0;
 }
 
-int INIRead(INI *INI, char *fileName)
+// The blocks and mappings the INI holds on to, in bytes
+static int64_t INIHeldSize(INI *INI)
 {
-    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
-    Assert(fileName, EINVAL, INIStreamStatusFatalFailure);
+    int64_t size = 0;
+    for(INIArena *arena = INIFirstArena(INI); arena != NULL; arena = arena->NextArena)
+        size += arena->Size;
+    for(INIMapping *mapping = INI->Mappings; mapping != NULL; mapping = mapping->PreviousMapping)
+        size += mapping->Size;
 
-    int retVal = INIStreamStatusSuccess;
+    return size;
+}
 
-    FILE *file = fopen(fileName, "r");
-    Assert(file != NULL, errno, INIStreamStatusFatalFailure);
+// Leaves the current block with room for the given size, so the next allocations of that much all come from it
+static int INIArenaReserve(INI *INI, size_t size)
+{
+    char *reserved;
+    TryNotNull(reserved = INIAllocate(INI, size), -1);
+    ((INIArena *)INI->Arena)->Used = reserved - (char *)INI->Arena;
 
-    char buffer[256];
-    INIStream stream = INIStreamDefault;
-    size_t sectionParseFailCount = 0;
+    return 0;
+}
 
-    while(1)
+static size_t INICompactAdd(size_t offset, size_t size, size_t alignment)
+{
+    return INIAlign(offset, alignment) + size;
+}
+
+static size_t INIValueSize(const INIPair *pair)
+{
+    if(pair->RawLength != 0)
+        return pair->RawLength + 1;
+
+    return pair->Type == INITypeString ? strlen(pair->Value) + 1 : 0;
+}
+
+// Works out the size of everything INICompactInto allocates by replaying its allocations in the same order
+static size_t INICompactSize(INI *INI, size_t sectionCount, size_t pairCount)
+{
+    size_t offset = 0, entrySize = sizeof(INIIndexEntry);
+
+    if(INI->Index != NULL)
     {
-        size_t read = fread(buffer, sizeof(char), sizeof(buffer), file);
-        stream.IOStream = buffer;
-        stream.IOStreamCount = read; 
+        offset = INICompactAdd(offset, sizeof(INIIndex), ArenaAlignment);
+        if(sectionCount != 0)
+            offset = INICompactAdd(offset, INITableCapacity(sectionCount) * entrySize, ArenaAlignment);
+        if(pairCount != 0)
+            offset = INICompactAdd(offset, INITableCapacity(pairCount) * entrySize, ArenaAlignment);
+    }
 
-        while(1)
+    if(INI->Strings != NULL)
+    {
+        INITable *names = &INI->Strings->Names;
+        offset = INICompactAdd(offset, sizeof(INIStrings), ArenaAlignment);
+        if(names->Count != 0)
+            offset = INICompactAdd(offset, INITableCapacity(names->Count) * entrySize, ArenaAlignment);
+
+        for(size_t x = 0; x < names->Capacity; x++)
         {
-            int code = INIStreamRead(INI, &stream);
-            switch(code)
-            {
-                case INIStreamStatusFatalFailure:
-                    retVal = INIStreamStatusFatalFailure;
-                    goto End;
-                case INIStreamStatusSuccess:
-                    goto Continue;
-                case INIStreamStatusPairParseFailed:
-                    continue;
-                case INIStreamStatusSectionHeaderParseFailed:
-                {
-                    char fallbackSectionName[64];
-                    snprintf(fallbackSectionName, sizeof(fallbackSectionName), "ParseFailed_%zu", sectionParseFailCount);
-                    INIAddSection(INI, fallbackSectionName);
-                    sectionParseFailCount++;
-                    continue;
-                }
-            }
+            if(names->Entries[x].Element != NULL)
+                offset = INICompactAdd(offset, sizeof(char *), _Alignof(char *)) + strlen(*(char **)names->Entries[x].Element) + 1;
         }
+    }
 
-        Continue:
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section))
+    {
+        offset = INICompactAdd(offset, sizeof(INISection), ArenaAlignment) + (INI->Strings == NULL ? strlen(section->Name) + 1 : 0);
 
-        if(feof(file))
-            break;
-        AssertDo(!ferror(file), ferror(file), retVal = INIStreamStatusFatalFailure; goto End;);
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            offset = INICompactAdd(offset, sizeof(INIPair), ArenaAlignment) + (INI->Strings == NULL ? strlen(pair->Key) + 1 : 0) + INIValueSize(pair);
     }
 
-    End:
-    fclose(file);
-    INIStreamFree(&stream);
-    return retVal;
+    return offset;
 }
 
-int INIWrite(INI *INI, char *fileName)
+// Copies the live sections, pairs and values of the INI into the empty one, whose index and interning match those of the INI
+static int INICompactInto(INI *INI, struct INI *compact, size_t sectionCount, size_t pairCount)
 {
-    Assert(INI, EINVAL, INIStreamStatusFatalFailure);
-    Assert(fileName, EINVAL, INIStreamStatusFatalFailure);
-
-    int retVal = INIStreamStatusSuccess;
-
-    FILE *file = fopen(fileName, "w");
-    Assert(file, errno, INIStreamStatusFatalFailure);
+    size_t size = INICompactSize(INI, sectionCount, pairCount);
+    if(size != 0)
+        Try(INIArenaReserve(compact, size), -1);
 
-    char buffer[256];
-    INIStream stream = INIStreamDefault;
+    if(INI->Index != NULL)
+    {
+        TryNotNull(compact->Index = INIAllocate(compact, sizeof(*compact->Index)), -1);
+        memset(compact->Index, 0, sizeof(*compact->Index));
+        Try(INITableReserve(compact, &compact->Index->Sections, sectionCount), -1);
+        Try(INITableReserve(compact, &compact->Index->Pairs, pairCount), -1);
+    }
 
-    while (1)
+    // Names are interned first, so the copies below only look them up. Names of removed pairs stay interned
+    if(INI->Strings != NULL)
     {
-        stream.IOStream = buffer;
-        stream.IOStreamCount = sizeof(buffer);
+        INITable *names = &INI->Strings->Names;
+        TryNotNull(compact->Strings = INIAllocate(compact, sizeof(*compact->Strings)), -1);
+        memset(compact->Strings, 0, sizeof(*compact->Strings));
+        Try(INITableReserve(compact, &compact->Strings->Names, names->Count), -1);
 
-        while (1)
+        for(size_t x = 0; x < names->Capacity; x++)
         {
-            int code = INIStreamWrite(INI, &stream);
+            char *name = names->Entries[x].Element != NULL ? *(char **)names->Entries[x].Element : NULL;
+            if(name != NULL)
+                TryNotNull(INIInternName(compact, NULL, name, strlen(name), NULL), -1);
+        }
+    }
 
-            switch(code)
-            {
-                case INIStreamStatusFatalFailure:
-                    retVal = INIStreamStatusFatalFailure;
-                    goto End;
-                case INIStreamStatusSuccess:
-                {
-                    fwrite(buffer, sizeof(char), sizeof(buffer) - stream.IOStreamCount, file);
-                    AssertDo(!ferror(file), ferror(file), retVal = INIStreamStatusFatalFailure;);
-                    goto End;
-                }
-                case INIStreamStatusContinue:
-                    goto Continue;
-                case INIStreamStatusInvalidType:
-                    continue;
-            }
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section))
+    {
+        INISection *newSection;
+        TryNotNull(newSection = INIAddLinkedListElement(compact, (void **)&compact->FirstSection, (void **)&compact->LastSection, sizeof(*newSection), offsetof(INISection, NextSection)), -1);
+        TryNotNull(newSection->Name = INIStoreName(compact, NULL, section->Name, strlen(section->Name)), -1);
+        newSection->FirstPair = NULL;
+        newSection->LastPair = NULL;
+        newSection->Owner = INI;
+
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+        {
+            INIPair *newPair;
+            TryNotNull(newPair = INIAddLinkedListElement(compact, (void **)&newSection->FirstPair, (void **)&newSection->LastPair, sizeof(*newPair), offsetof(INIPair, NextPair)), -1);
+            *newPair = *pair;
+            newPair->NextPair = NULL;
+            TryNotNull(newPair->Key = INIStoreName(compact, NULL, pair->Key, strlen(pair->Key)), -1);
+
+            size_t valueSize = INIValueSize(pair);
+            if(valueSize != 0)
+                TryNotNull(newPair->Value = INIStoreString(compact, pair->Value, valueSize - 1), -1);
+
+            if(compact->Index != NULL)
+                Try(INIIndexAddPair(compact, newSection, newPair), -1);
         }
 
-        Continue:
-        
-        fwrite(buffer, sizeof(char), sizeof(buffer), file);
-        AssertDo(!ferror(file), ferror(file), retVal = INIStreamStatusFatalFailure; goto End;);
+        if(compact->Index != NULL)
+            Try(INIIndexAddSection(compact, newSection), -1);
     }
 
-    End:
-    fclose(file);
-    INIStreamFree(&stream);
-    return retVal;
+    return 0;
+}
+
+int INICompact(INI *INI, int64_t *reclaimed)
+{
+    Assert(INI, EINVAL, -1);
+    AssertMsg(INI->Frozen == NULL, EPERM, -1, FrozenMessage);
+
+    size_t sectionCount = 0, pairCount = 0;
+    for(INISection *section = INI->FirstSection; section != NULL; section = INISectionAfter(INI, section), sectionCount++)
+    {
+        for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+            pairCount++;
+    }
+
+    struct INI compact = INIDefault;
+    AssertDo(INICompactInto(INI, &compact, sectionCount, pairCount) == 0, ENOMEM, INIArenaFree(INIFirstArena(&compact)); return -1;);
+
+    int64_t heldSize = INIHeldSize(INI);
+    INIUnmapAll(INI);
+    INIArenaFree(INIFirstArena(INI));
+
+    INI->Arena = compact.Arena;
+    INI->Index = compact.Index;
+    INI->Strings = compact.Strings;
+    INI->FirstSection = compact.FirstSection;
+    INI->LastSection = compact.LastSection;
+    INI->Version++;
+
+    // A clone has copies of everything now
+    INISharedRelease(INI);
+
+    if(INI->Journal != NULL)
+        Try(INIJournalTrackAll(INI), -1);
+
+    if(reclaimed != NULL)
+        *reclaimed = heldSize - INIHeldSize(INI);
+
+    return 0;
+}
+
+int INIReset(INI *INI)
+{
+    Assert(INI, EINVAL, -1);
+
+    INIUnmapAll(INI);
+    INIArenaRewind(INI);
+
+    INIFrozenRelease(INI->Frozen);
+    INISharedRelease(INI);
+    INI->Frozen = NULL;
+
+    // The journal stays enabled for the next INIRead
+    if(INI->Journal != NULL)
+    {
+        INIJournalClose(INI->Journal);
+        memset(&INI->Journal->Pairs, 0, sizeof(INI->Journal->Pairs));
+    }
+
+    int indexed = INI->Index != NULL, interned = INI->Strings != NULL;
+    INI->Index = NULL;
+    INI->Strings = NULL;
+    INI->FirstSection = NULL;
+    INI->LastSection = NULL;
+    INI->Version++;
+
+    if(indexed)
+        Try(INIEnableIndex(INI), -1);
+    if(interned)
+        Try(INIEnableInterning(INI), -1);
+
+    return 0;
 }
 
 void INIFree(INI *INI)
 {
     Assert(INI, EINVAL, );
 
-    INIArena *arena = INI->Arena;
+    INIUnmapAll(INI);
+    INIArenaFree(INIFirstArena(INI));
 
-    while(arena != NULL)
+    INIFrozenRelease(INI->Frozen);
+    INISharedRelease(INI);
+    free(INI->Stats);
+
+    if(INI->Journal != NULL)
     {
-        void *temp = arena;
-        arena = arena->PreviousArena;
-        free(temp);
+        INIJournalClose(INI->Journal);
+        free(INI->Journal->File);
+        free(INI->Journal->LogFile);
+        free(INI->Journal);
     }
-}
\ No newline at end of file
+
+    INI->Arena = NULL;
+    INI->Index = NULL;
+    INI->Strings = NULL;
+    INI->Frozen = NULL;
+    INI->Shared = NULL;
+    INI->Stats = NULL;
+    INI->Journal = NULL;
+    INI->LazyValues = 0;
+    INI->Version++;
+    INI->FirstSection = NULL;
+    INI->LastSection = NULL;
+}
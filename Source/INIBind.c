@@ -0,0 +1,444 @@
+#include "INIAccess.h"
+#include "INIInternal.h"
+#include "Assert.h"
+#include "Try.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum BindConstants
+{
+    BindBatchSize = 32,
+    BindNamesBaseCapacity = 16
+};
+
+static const char *InvalidFieldMessage = "The field does not match the type of its member";
+
+// A value from a pair or a line, strings are views that are not terminated
+typedef struct INIBindValue
+{
+    enum INIType Type;
+    int64_t Int;
+    double Float;
+    const char *String;
+    size_t Length;
+} INIBindValue;
+
+// A section header the file had already, copied as the lines are only views
+typedef struct INIBindingName
+{
+    char *Name;
+    uint32_t Hash;
+} INIBindingName;
+
+// Slots hold the index of a field plus one, 0 is empty. Pairs are keyed by their section and key, sections by their name
+// and only hold the first field of each section
+typedef struct INIBinding
+{
+    const INIField *Fields;
+    size_t Count;
+    void *Target;
+    enum INILookupStatus *Statuses;
+    size_t Seen;
+
+    size_t *PairSlots;
+    size_t *SectionSlots;
+    size_t Mask;
+
+    // The name of the section the lines are in as the fields have it, NULL while none of them is in it
+    const char *Section;
+    uint32_t SectionHash;
+
+    // Repeated headers start a section of their own like in INIRead, which names them like headers that failed to parse
+    INIBindingName *Names;
+    size_t NameCount;
+    size_t NameCapacity;
+    size_t SectionParseFailCount;
+    int Failed;
+} INIBinding;
+
+static int INIFieldValid(const INIField *field)
+{
+    if(field->Section == NULL || field->Key == NULL)
+        return 0;
+
+    switch(field->Type)
+    {
+        case INITypeString:
+            return field->Size > 0;
+        case INITypeInt:
+            return field->Size == sizeof(int64_t);
+        case INITypeFloat:
+            return field->Size == sizeof(double);
+        default:
+            return 0;
+    }
+}
+
+static enum INILookupStatus INIFieldStore(const INIField *field, void *target, const INIBindValue *value)
+{
+    char *member = (char *)target + field->Offset;
+
+    if(field->Type == INITypeFloat && value->Type == INITypeInt)
+    {
+        double number = (double)value->Int;
+        memcpy(member, &number, sizeof(number));
+        return INILookupStatusFound;
+    }
+
+    if(value->Type != field->Type)
+        return INILookupStatusTypeMismatch;
+
+    switch(field->Type)
+    {
+        case INITypeString:
+            if(value->Length >= field->Size)
+                return INILookupStatusTooLong;
+            memcpy(member, value->String, value->Length);
+            member[value->Length] = '\0';
+            break;
+        case INITypeInt:
+            memcpy(member, &value->Int, sizeof(value->Int));
+            break;
+        default:
+            memcpy(member, &value->Float, sizeof(value->Float));
+            break;
+    }
+
+    return INILookupStatusFound;
+}
+
+// Fills the member of a field from its value, or its default if the value is NULL. Returns 1 if the field failed
+static int INIFieldFill(const INIField *field, void *target, const INIBindValue *value, enum INILookupStatus *status)
+{
+    enum INILookupStatus result;
+    if(value != NULL)
+        result = INIFieldStore(field, target, value);
+    else if(field->Required)
+        result = INILookupStatusMissing;
+    else
+    {
+        INIBindValue fallback = {field->Type, 0, 0, "", 0};
+        if(field->Type == INITypeInt)
+            fallback.Int = field->Default.Int;
+        else if(field->Type == INITypeFloat)
+            fallback.Float = field->Default.Float;
+        else if(field->Default.String != NULL)
+        {
+            fallback.String = field->Default.String;
+            fallback.Length = strlen(field->Default.String);
+        }
+
+        result = INIFieldStore(field, target, &fallback);
+        if(result == INILookupStatusFound)
+            result = INILookupStatusMissing;
+    }
+
+    if(status != NULL)
+        *status = result;
+
+    return result != INILookupStatusFound && (result != INILookupStatusMissing || field->Required);
+}
+
+static int INIFieldsCheck(const INIField *fields, size_t count)
+{
+    for(size_t x = 0; x < count; x++)
+        AssertMsg(INIFieldValid(fields + x), EINVAL, -1, InvalidFieldMessage);
+
+    return 0;
+}
+
+static INIBindValue INIPairValue(INIPair *pair)
+{
+    INIBindValue value = {pair->Type, 0, 0, NULL, 0};
+    void *data = INIGetValue(pair, pair->Type);
+
+    switch(pair->Type)
+    {
+        case INITypeString:
+            value.String = data;
+            value.Length = strlen(data);
+            break;
+        case INITypeInt:
+            value.Int = *(int64_t *)data;
+            break;
+        case INITypeFloat:
+            value.Float = *(double *)data;
+            break;
+        default:
+            break;
+    }
+
+    return value;
+}
+
+int INIBind(INI *INI, const INIField *fields, size_t count, void *target, enum INILookupStatus *statuses)
+{
+    Assert(INI, EINVAL, -1);
+    Assert(fields || count == 0, EINVAL, -1);
+    Assert(target, EINVAL, -1);
+    Try(INIFieldsCheck(fields, count), -1);
+
+    int failed = 0;
+    INILookup lookups[BindBatchSize];
+
+    for(size_t first = 0; first < count;)
+    {
+        size_t end = first + 1;
+        while(end < count && end - first < BindBatchSize && strcmp(fields[end].Section, fields[first].Section) == 0)
+            end++;
+
+        for(size_t x = first; x < end; x++)
+            lookups[x - first] = (INILookup){.Key = (char *)fields[x].Key, .Type = fields[x].Type, .Pair = NULL};
+
+        INISection *section = INIFindSection(INI, (char *)fields[first].Section);
+        if(section != NULL)
+            Try(INIFindValues(section, lookups, end - first), -1);
+
+        // The pair is set for keys of another type as well, which float fields may take
+        for(size_t x = first; x < end; x++)
+        {
+            INIPair *pair = lookups[x - first].Pair;
+            INIBindValue value = pair != NULL ? INIPairValue(pair) : (INIBindValue){0};
+            failed += INIFieldFill(fields + x, target, pair != NULL ? &value : NULL, statuses != NULL ? statuses + x : NULL);
+        }
+
+        first = end;
+    }
+
+    return failed;
+}
+
+static uint32_t INIBindPairHash(uint32_t sectionHash, uint32_t keyHash)
+{
+    return (sectionHash * 16777619u) ^ keyHash;
+}
+
+static int INIBindNameEquals(const char *name, const char *view, size_t length)
+{
+    return strncmp(name, view, length) == 0 && name[length] == '\0';
+}
+
+static void INIBindingInsert(size_t *slots, size_t mask, uint32_t hash, size_t index)
+{
+    size_t slot = hash & mask;
+    while(slots[slot] != 0)
+        slot = (slot + 1) & mask;
+
+    slots[slot] = index + 1;
+}
+
+// The name of the section as the fields have it, NULL if none of them is in it
+static const char *INIBindingFindSection(INIBinding *binding, const char *name, size_t length, uint32_t hash)
+{
+    for(size_t slot = hash & binding->Mask; binding->SectionSlots[slot] != 0; slot = (slot + 1) & binding->Mask)
+    {
+        const INIField *field = binding->Fields + binding->SectionSlots[slot] - 1;
+        if(INIBindNameEquals(field->Section, name, length))
+            return field->Section;
+    }
+
+    return NULL;
+}
+
+static INIBindingName *INIBindingFindName(INIBindingName *names, size_t capacity, const char *name, size_t length, uint32_t hash)
+{
+    size_t slot = hash & (capacity - 1);
+    for(; names[slot].Name != NULL; slot = (slot + 1) & (capacity - 1))
+    {
+        if(names[slot].Hash == hash && INIBindNameEquals(names[slot].Name, name, length))
+            break;
+    }
+
+    return names + slot;
+}
+
+// Returns 1 if the file had the header already, 0 once it is noted
+static int INIBindingNoteName(INIBinding *binding, const char *name, size_t length, uint32_t hash)
+{
+    if(binding->NameCapacity != 0)
+    {
+        INIBindingName *slot = INIBindingFindName(binding->Names, binding->NameCapacity, name, length, hash);
+        if(slot->Name != NULL)
+            return 1;
+    }
+
+    if((binding->NameCount + 1) * 2 > binding->NameCapacity)
+    {
+        size_t capacity = binding->NameCapacity != 0 ? binding->NameCapacity * 2 : BindNamesBaseCapacity;
+
+        INIBindingName *names;
+        TryNotNull(names = calloc(capacity, sizeof(*names)), -1);
+        for(size_t x = 0; x < binding->NameCapacity; x++)
+        {
+            INIBindingName *old = binding->Names + x;
+            if(old->Name != NULL)
+                *INIBindingFindName(names, capacity, old->Name, strlen(old->Name), old->Hash) = *old;
+        }
+
+        free(binding->Names);
+        binding->Names = names;
+        binding->NameCapacity = capacity;
+    }
+
+    char *copy;
+    TryNotNull(copy = malloc(length + 1), -1);
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+
+    *INIBindingFindName(binding->Names, binding->NameCapacity, name, length, hash) = (INIBindingName){copy, hash};
+    binding->NameCount++;
+    return 0;
+}
+
+static void INIBindingFreeNames(INIBinding *binding)
+{
+    for(size_t x = 0; x < binding->NameCapacity; x++)
+        free(binding->Names[x].Name);
+
+    free(binding->Names);
+}
+
+// Enters the section of a header, returns 1 instead if the file had the header already
+static int INIBindingEnter(INIBinding *binding, const char *name, size_t length)
+{
+    uint32_t hash = INIHash(name, length);
+
+    int seen;
+    Try(seen = INIBindingNoteName(binding, name, length, hash), -1);
+
+    if(!seen)
+    {
+        binding->SectionHash = hash;
+        binding->Section = INIBindingFindSection(binding, name, length, hash);
+    }
+
+    return seen;
+}
+
+// The lines of a repeated or broken header go to a section of their own, named the way INIRead names it
+static int INIBindingFallback(INIBinding *binding)
+{
+    char name[FallbackNameSize];
+    INIFallbackSectionName(name, binding->SectionParseFailCount++);
+
+    int seen;
+    Try(seen = INIBindingEnter(binding, name, strlen(name)), -1);
+
+    // INIRead cannot add a section that is there already, so the lines of this one are left out
+    if(seen)
+        binding->Section = NULL;
+
+    return 0;
+}
+
+// Running out of memory stops the parse, which INIBindFile then fails
+static int INIBindingSection(void *context, const char *name, size_t length)
+{
+    INIBinding *binding = context;
+
+    int seen = INIBindingEnter(binding, name, length);
+    if(seen == 1)
+        seen = INIBindingFallback(binding);
+
+    binding->Failed = seen < 0;
+    return binding->Failed;
+}
+
+static int INIBindingError(void *context, enum INIStreamStatus status, const char *line, size_t length)
+{
+    (void)line;
+    (void)length;
+
+    INIBinding *binding = context;
+    if(status == INIStreamStatusSectionHeaderParseFailed)
+        binding->Failed = INIBindingFallback(binding) < 0;
+
+    return binding->Failed;
+}
+
+static int INIBindingPair(void *context, const char *key, size_t keyLength, const char *value, size_t valueLength, enum INIType type)
+{
+    INIBinding *binding = context;
+    if(binding->Section == NULL)
+        return 0;
+
+    uint32_t hash = INIBindPairHash(binding->SectionHash, INIHash(key, keyLength));
+    for(size_t slot = hash & binding->Mask; binding->PairSlots[slot] != 0; slot = (slot + 1) & binding->Mask)
+    {
+        size_t index = binding->PairSlots[slot] - 1;
+        const INIField *field = binding->Fields + index;
+        if(binding->Statuses[index] != INILookupStatusMissing || !INIBindNameEquals(field->Key, key, keyLength) || strcmp(field->Section, binding->Section) != 0)
+            continue;
+
+        // The lexer only reports numbers it could parse, so the text is known to be valid
+        INIBindValue bound = {type, 0, 0, value, valueLength};
+        if(type == INITypeInt)
+            INIParseInt(value, valueLength, &bound.Int);
+        else if(type == INITypeFloat && INIParseFloat(value, valueLength, &bound.Float) != valueLength)
+            bound.Float = strtod(value, NULL);
+
+        binding->Statuses[index] = INIFieldStore(field, binding->Target, &bound);
+        binding->Seen++;
+    }
+
+    // Everything after the last field is of no use
+    return binding->Seen == binding->Count;
+}
+
+int INIBindFile(char *file, const INIField *fields, size_t count, void *target, enum INILookupStatus *statuses)
+{
+    Assert(file, EINVAL, -1);
+    Assert(fields || count == 0, EINVAL, -1);
+    Assert(target, EINVAL, -1);
+    Try(INIFieldsCheck(fields, count), -1);
+
+    if(count == 0)
+        return 0;
+
+    size_t capacity = 16;
+    while(capacity < count * 2)
+        capacity *= 2;
+
+    INIBinding binding = {fields, count, target, NULL, 0, NULL, NULL, capacity - 1, NULL, 0, NULL, 0, 0, 0, 0};
+    TryNotNull(binding.Statuses = malloc(count * sizeof(*binding.Statuses)), -1);
+    TryNotNull(binding.PairSlots = calloc(capacity * 2, sizeof(*binding.PairSlots)), -1, free(binding.Statuses););
+    binding.SectionSlots = binding.PairSlots + capacity;
+
+    for(size_t x = 0; x < count; x++)
+    {
+        size_t length = strlen(fields[x].Section);
+        uint32_t sectionHash = INIHash(fields[x].Section, length);
+        INIBindingInsert(binding.PairSlots, binding.Mask, INIBindPairHash(sectionHash, INIHash(fields[x].Key, strlen(fields[x].Key))), x);
+        binding.Statuses[x] = INILookupStatusMissing;
+
+        if(INIBindingFindSection(&binding, fields[x].Section, length, sectionHash) == NULL)
+            INIBindingInsert(binding.SectionSlots, binding.Mask, sectionHash, x);
+    }
+
+    INIHandlers handlers = {&binding, INIBindingSection, INIBindingPair, INIBindingError};
+    int code = INIParse(file, &handlers);
+    AssertDo(!binding.Failed, ENOMEM, code = INIStreamStatusFatalFailure;);
+
+    int failed = 0;
+    if(code == INIStreamStatusSuccess || code == INIStreamStatusStopped)
+    {
+        for(size_t x = 0; x < count; x++)
+        {
+            enum INILookupStatus *status = statuses != NULL ? statuses + x : NULL;
+            if(binding.Statuses[x] == INILookupStatusMissing)
+                failed += INIFieldFill(fields + x, target, NULL, status);
+            else
+            {
+                failed += binding.Statuses[x] != INILookupStatusFound;
+                if(status != NULL)
+                    *status = binding.Statuses[x];
+            }
+        }
+    }
+
+    INIBindingFreeNames(&binding);
+    free(binding.Statuses);
+    free(binding.PairSlots);
+
+    return code == INIStreamStatusSuccess || code == INIStreamStatusStopped ? failed : -1;
+}
@@ -0,0 +1,735 @@
+#include "INIAccess.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// Shortest round trip formatting with Grisu2 and correctly rounded parsing of decimal floats, independent of the locale
+
+enum FloatConstants
+{
+    SignificandBits = 52,
+    ExponentBias = 1075,
+    MaxFastExponent = 22,
+    MaxParsedDigits = 19,
+    MaxExactDigits = 768,
+    BigWordCount = 160
+};
+
+typedef struct DiyFp
+{
+    uint64_t F;
+    int E;
+} DiyFp;
+
+// Normalized powers of ten from 10^-348 to 10^340 in steps of 8
+static const DiyFp CachedPowers[] =
+{
+    {0xfa8fd5a0081c0288u, -1220}, {0xbaaee17fa23ebf76u, -1193}, {0x8b16fb203055ac76u, -1166},
+    {0xcf42894a5dce35eau, -1140}, {0x9a6bb0aa55653b2du, -1113}, {0xe61acf033d1a45dfu, -1087},
+    {0xab70fe17c79ac6cau, -1060}, {0xff77b1fcbebcdc4fu, -1034}, {0xbe5691ef416bd60cu, -1007},
+    {0x8dd01fad907ffc3cu, -980}, {0xd3515c2831559a83u, -954}, {0x9d71ac8fada6c9b5u, -927},
+    {0xea9c227723ee8bcbu, -901}, {0xaecc49914078536du, -874}, {0x823c12795db6ce57u, -847},
+    {0xc21094364dfb5637u, -821}, {0x9096ea6f3848984fu, -794}, {0xd77485cb25823ac7u, -768},
+    {0xa086cfcd97bf97f4u, -741}, {0xef340a98172aace5u, -715}, {0xb23867fb2a35b28eu, -688},
+    {0x84c8d4dfd2c63f3bu, -661}, {0xc5dd44271ad3cdbau, -635}, {0x936b9fcebb25c996u, -608},
+    {0xdbac6c247d62a584u, -582}, {0xa3ab66580d5fdaf6u, -555}, {0xf3e2f893dec3f126u, -529},
+    {0xb5b5ada8aaff80b8u, -502}, {0x87625f056c7c4a8bu, -475}, {0xc9bcff6034c13053u, -449},
+    {0x964e858c91ba2655u, -422}, {0xdff9772470297ebdu, -396}, {0xa6dfbd9fb8e5b88fu, -369},
+    {0xf8a95fcf88747d94u, -343}, {0xb94470938fa89bcfu, -316}, {0x8a08f0f8bf0f156bu, -289},
+    {0xcdb02555653131b6u, -263}, {0x993fe2c6d07b7facu, -236}, {0xe45c10c42a2b3b06u, -210},
+    {0xaa242499697392d3u, -183}, {0xfd87b5f28300ca0eu, -157}, {0xbce5086492111aebu, -130},
+    {0x8cbccc096f5088ccu, -103}, {0xd1b71758e219652cu, -77}, {0x9c40000000000000u, -50},
+    {0xe8d4a51000000000u, -24}, {0xad78ebc5ac620000u, 3}, {0x813f3978f8940984u, 30},
+    {0xc097ce7bc90715b3u, 56}, {0x8f7e32ce7bea5c70u, 83}, {0xd5d238a4abe98068u, 109},
+    {0x9f4f2726179a2245u, 136}, {0xed63a231d4c4fb27u, 162}, {0xb0de65388cc8ada8u, 189},
+    {0x83c7088e1aab65dbu, 216}, {0xc45d1df942711d9au, 242}, {0x924d692ca61be758u, 269},
+    {0xda01ee641a708deau, 295}, {0xa26da3999aef774au, 322}, {0xf209787bb47d6b85u, 348},
+    {0xb454e4a179dd1877u, 375}, {0x865b86925b9bc5c2u, 402}, {0xc83553c5c8965d3du, 428},
+    {0x952ab45cfa97a0b3u, 455}, {0xde469fbd99a05fe3u, 481}, {0xa59bc234db398c25u, 508},
+    {0xf6c69a72a3989f5cu, 534}, {0xb7dcbf5354e9beceu, 561}, {0x88fcf317f22241e2u, 588},
+    {0xcc20ce9bd35c78a5u, 614}, {0x98165af37b2153dfu, 641}, {0xe2a0b5dc971f303au, 667},
+    {0xa8d9d1535ce3b396u, 694}, {0xfb9b7cd9a4a7443cu, 720}, {0xbb764c4ca7a44410u, 747},
+    {0x8bab8eefb6409c1au, 774}, {0xd01fef10a657842cu, 800}, {0x9b10a4e5e9913129u, 827},
+    {0xe7109bfba19c0c9du, 853}, {0xac2820d9623bf429u, 880}, {0x80444b5e7aa7cf85u, 907},
+    {0xbf21e44003acdd2du, 933}, {0x8e679c2f5e44ff8fu, 960}, {0xd433179d9c8cb841u, 986},
+    {0x9e19db92b4e31ba9u, 1013}, {0xeb96bf6ebadf77d9u, 1039}, {0xaf87023b9bf0ee6bu, 1066},
+};
+
+static const uint64_t PowersOfTen[] = 
+{
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u, 10000000000u, 100000000000u,
+    1000000000000u, 10000000000000u, 100000000000000u, 1000000000000000u, 10000000000000000u, 100000000000000000u,
+    1000000000000000000u, 10000000000000000000u
+};
+
+#if FLT_EVAL_METHOD == 0
+static const double ExactPowersOfTen[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#endif
+
+static uint64_t DoubleToBits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double BitsToDouble(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Grisu2, see "Printing Floating-Point Numbers Quickly and Accurately with Integers" by Florian Loitsch
+
+static DiyFp DiyFpFromDouble(double value)
+{
+    uint64_t bits = DoubleToBits(value);
+    uint64_t significand = bits & (((uint64_t)1 << SignificandBits) - 1);
+    int exponent = (int)((bits >> SignificandBits) & 0x7FF);
+
+    if(exponent == 0)
+        return (DiyFp){significand, 1 - ExponentBias};
+
+    return (DiyFp){significand + ((uint64_t)1 << SignificandBits), exponent - ExponentBias};
+}
+
+static DiyFp DiyFpMultiply(DiyFp a, DiyFp b)
+{
+    const uint64_t mask = 0xFFFFFFFFu;
+    uint64_t aHigh = a.F >> 32, aLow = a.F & mask, bHigh = b.F >> 32, bLow = b.F & mask;
+    uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow, lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+
+    // Rounds the lower half into the result
+    uint64_t middle = (lowLow >> 32) + (highLow & mask) + (lowHigh & mask) + ((uint64_t)1 << 31);
+    return (DiyFp){highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32), a.E + b.E + 64};
+}
+
+static DiyFp DiyFpNormalize(DiyFp value)
+{
+    while(!(value.F & ((uint64_t)1 << 63)))
+    {
+        value.F <<= 1;
+        value.E--;
+    }
+
+    return value;
+}
+
+static void DiyFpBoundaries(DiyFp value, DiyFp *minus, DiyFp *plus)
+{
+    *plus = DiyFpNormalize((DiyFp){(value.F << 1) + 1, value.E - 1});
+
+    // The lower boundary is closer when the significand is a power of two, as the exponent below is smaller
+    if(value.F == ((uint64_t)1 << SignificandBits))
+        *minus = (DiyFp){(value.F << 2) - 1, value.E - 2};
+    else
+        *minus = (DiyFp){(value.F << 1) - 1, value.E - 1};
+
+    minus->F <<= minus->E - plus->E;
+    minus->E = plus->E;
+}
+
+static DiyFp CachedPowerFor(int exponent, int *decimalExponent)
+{
+    // Picks a power that brings the binary exponent of the product into [-60, -32]
+    double estimate = (-61 - exponent) * 0.30102999566398114 + 347;
+    int k = (int)estimate;
+    if(estimate - k > 0)
+        k++;
+
+    unsigned index = (unsigned)((k >> 3) + 1);
+    *decimalExponent = -(-348 + (int)index * 8);
+
+    return CachedPowers[index];
+}
+
+static int CountDigits(uint32_t value)
+{
+    int count = 1;
+    while(count < 10 && value >= PowersOfTen[count])
+        count++;
+
+    return count;
+}
+
+static int CountDigits64(uint64_t value)
+{
+    int count = 1;
+    while(count < 20 && value >= PowersOfTen[count])
+        count++;
+
+    return count;
+}
+
+static void GrisuRound(char *digits, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    while(rest < distance && delta - rest >= tenKappa && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance))
+    {
+        digits[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+static int GrisuDigits(DiyFp value, DiyFp upper, uint64_t delta, char *digits, int *decimalExponent)
+{
+    DiyFp one = {(uint64_t)1 << -upper.E, upper.E};
+    uint64_t distance = upper.F - value.F;
+    uint32_t integral = (uint32_t)(upper.F >> -one.E);
+    uint64_t fraction = upper.F & (one.F - 1);
+    int kappa = CountDigits(integral);
+    int length = 0;
+
+    while(kappa > 0)
+    {
+        uint32_t power = (uint32_t)PowersOfTen[kappa - 1];
+        uint32_t digit = integral / power;
+        integral %= power;
+
+        if(digit != 0 || length != 0)
+            digits[length++] = (char)('0' + digit);
+
+        kappa--;
+
+        uint64_t rest = ((uint64_t)integral << -one.E) + fraction;
+        if(rest <= delta)
+        {
+            *decimalExponent += kappa;
+            GrisuRound(digits, length, delta, rest, PowersOfTen[kappa] << -one.E, distance);
+            return length;
+        }
+    }
+
+    while(1)
+    {
+        fraction *= 10;
+        delta *= 10;
+
+        char digit = (char)(fraction >> -one.E);
+        if(digit != 0 || length != 0)
+            digits[length++] = (char)('0' + digit);
+
+        fraction &= one.F - 1;
+        kappa--;
+
+        if(fraction < delta)
+        {
+            *decimalExponent += kappa;
+            GrisuRound(digits, length, delta, fraction, one.F, -kappa < 20 ? distance * PowersOfTen[-kappa] : 0);
+            return length;
+        }
+    }
+}
+
+// Writes the digits of a positive, finite value, which is digits * 10^decimalExponent
+static int Grisu2(double value, char *digits, int *decimalExponent)
+{
+    DiyFp minus, plus;
+    DiyFp diy = DiyFpFromDouble(value);
+    DiyFpBoundaries(diy, &minus, &plus);
+
+    DiyFp power = CachedPowerFor(plus.E, decimalExponent);
+    DiyFp scaled = DiyFpMultiply(DiyFpNormalize(diy), power);
+    DiyFp scaledPlus = DiyFpMultiply(plus, power);
+    DiyFp scaledMinus = DiyFpMultiply(minus, power);
+
+    // Shrinks the boundaries by the possible rounding error, so every produced number reads back correctly
+    scaledMinus.F++;
+    scaledPlus.F--;
+
+    return GrisuDigits(scaled, scaledPlus, scaledPlus.F - scaledMinus.F, digits, decimalExponent);
+}
+
+static size_t WriteExponent(char *buffer, int exponent)
+{
+    size_t length = 0;
+    if(exponent < 0)
+    {
+        buffer[length++] = '-';
+        exponent = -exponent;
+    }
+
+    if(exponent >= 100)
+        buffer[length++] = (char)('0' + exponent / 100);
+    if(exponent >= 10)
+        buffer[length++] = (char)('0' + exponent / 10 % 10);
+    buffer[length++] = (char)('0' + exponent % 10);
+
+    return length;
+}
+
+size_t INIFormatFloat(double value, char *buffer)
+{
+    uint64_t bits = DoubleToBits(value);
+    size_t length = 0;
+
+    if((bits >> 52 & 0x7FF) == 0x7FF)
+    {
+        const char *special = (bits & (((uint64_t)1 << SignificandBits) - 1)) != 0 ? "nan" : (bits >> 63) ? "-inf" : "inf";
+        strcpy(buffer, special);
+        return strlen(special);
+    }
+
+    if(bits >> 63)
+    {
+        buffer[length++] = '-';
+        value = -value;
+    }
+
+    if(value == 0)
+    {
+        memcpy(buffer + length, "0.0", 4);
+        return length + 3;
+    }
+
+    char digits[20];
+    int decimalExponent;
+    int digitCount = Grisu2(value, digits, &decimalExponent);
+
+    // Position of the decimal point relative to the first digit
+    int point = digitCount + decimalExponent;
+
+    if(point > -5 && point <= 17)
+    {
+        if(point <= 0)
+        {
+            memcpy(buffer + length, "0.", 2);
+            length += 2;
+            memset(buffer + length, '0', -point);
+            length += -point;
+            memcpy(buffer + length, digits, digitCount);
+            length += digitCount;
+        }
+        else if(point >= digitCount)
+        {
+            // Whole numbers keep a fraction, so they are not read back as integers
+            memcpy(buffer + length, digits, digitCount);
+            length += digitCount;
+            memset(buffer + length, '0', point - digitCount);
+            length += point - digitCount;
+            memcpy(buffer + length, ".0", 2);
+            length += 2;
+        }
+        else
+        {
+            memcpy(buffer + length, digits, point);
+            length += point;
+            buffer[length++] = '.';
+            memcpy(buffer + length, digits + point, digitCount - point);
+            length += digitCount - point;
+        }
+    }
+    else
+    {
+        buffer[length++] = digits[0];
+        if(digitCount > 1)
+        {
+            buffer[length++] = '.';
+            memcpy(buffer + length, digits + 1, digitCount - 1);
+            length += digitCount - 1;
+        }
+
+        buffer[length++] = 'e';
+        length += WriteExponent(buffer + length, point - 1);
+    }
+
+    buffer[length] = '\0';
+    return length;
+}
+
+// Big integers for the exact comparisons of the parser, least significant word first
+
+typedef struct Big
+{
+    uint32_t Words[BigWordCount];
+    size_t Count;
+} Big;
+
+static void BigFromUint64(Big *big, uint64_t value)
+{
+    big->Count = 0;
+    while(value != 0)
+    {
+        big->Words[big->Count++] = (uint32_t)value;
+        value >>= 32;
+    }
+}
+
+static void BigMultiplyAdd(Big *big, uint32_t factor, uint32_t addend)
+{
+    uint64_t carry = addend;
+    for(size_t x = 0; x < big->Count; x++)
+    {
+        uint64_t product = (uint64_t)big->Words[x] * factor + carry;
+        big->Words[x] = (uint32_t)product;
+        carry = product >> 32;
+    }
+
+    if(carry != 0)
+        big->Words[big->Count++] = (uint32_t)carry;
+}
+
+static void BigMultiplyPow5(Big *big, int exponent)
+{
+    // 5^13 is the largest power of five that fits into 32 bits
+    for(; exponent >= 13; exponent -= 13)
+        BigMultiplyAdd(big, 1220703125u, 0);
+
+    if(exponent > 0)
+        BigMultiplyAdd(big, (uint32_t)(PowersOfTen[exponent] >> exponent), 0);
+}
+
+static void BigShiftLeft(Big *big, int bits)
+{
+    if(big->Count == 0 || bits == 0)
+        return;
+
+    size_t words = (size_t)bits / 32;
+    int shift = bits % 32;
+
+    if(shift != 0)
+    {
+        big->Words[big->Count] = 0;
+        for(size_t x = big->Count; x > 0; x--)
+            big->Words[x] = (big->Words[x] << shift) | (big->Words[x - 1] >> (32 - shift));
+        big->Words[0] <<= shift;
+
+        if(big->Words[big->Count] != 0)
+            big->Count++;
+    }
+
+    if(words != 0)
+    {
+        memmove(big->Words + words, big->Words, big->Count * sizeof(*big->Words));
+        memset(big->Words, 0, words * sizeof(*big->Words));
+        big->Count += words;
+    }
+}
+
+static int BigCompare(const Big *a, const Big *b)
+{
+    if(a->Count != b->Count)
+        return a->Count < b->Count ? -1 : 1;
+
+    for(size_t x = a->Count; x > 0; x--)
+    {
+        if(a->Words[x - 1] != b->Words[x - 1])
+            return a->Words[x - 1] < b->Words[x - 1] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+typedef struct Decimal
+{
+    const char *Digits;
+    size_t DigitCount;
+    int Exponent;
+} Decimal;
+
+static void BigFromDecimal(Big *big, const Decimal *decimal, int *exponent)
+{
+    big->Count = 0;
+    *exponent = decimal->Exponent;
+
+    const char *digit = decimal->Digits;
+    size_t count = decimal->DigitCount < MaxExactDigits ? decimal->DigitCount : MaxExactDigits;
+    uint32_t chunk = 0;
+    int chunkLength = 0;
+
+    for(size_t x = 0; x < count; digit++)
+    {
+        if(*digit == '.')
+            continue;
+
+        chunk = chunk * 10 + (uint32_t)(*digit - '0');
+        chunkLength++;
+        x++;
+
+        if(chunkLength == 9 || x == count)
+        {
+            BigMultiplyAdd(big, (uint32_t)PowersOfTen[chunkLength], chunk);
+            chunk = 0;
+            chunkLength = 0;
+        }
+    }
+
+    if(count == decimal->DigitCount)
+        return;
+
+    // No midpoint between two doubles has more than 767 significant digits, so the dropped digits only matter as a nonzero tail
+    *exponent += (int)(decimal->DigitCount - count);
+    for(size_t x = count; x < decimal->DigitCount; digit++)
+    {
+        if(*digit == '.')
+            continue;
+
+        if(*digit != '0')
+        {
+            BigMultiplyAdd(big, 10, 1);
+            (*exponent)--;
+            return;
+        }
+
+        x++;
+    }
+}
+
+// Compares digits * 10^exponent with the midpoint between value and the next larger double
+static int CompareToMidpoint(const Big *digits, int exponent, double value)
+{
+    uint64_t bits = DoubleToBits(value);
+    int binaryExponent = (int)(bits >> SignificandBits);
+    uint64_t significand = bits & (((uint64_t)1 << SignificandBits) - 1);
+
+    if(binaryExponent == 0)
+        binaryExponent = 1 - ExponentBias;
+    else
+    {
+        significand += (uint64_t)1 << SignificandBits;
+        binaryExponent -= ExponentBias;
+    }
+
+    Big left = *digits, right;
+    BigFromUint64(&right, significand * 2 + 1);
+
+    // Both sides are brought to integers: digits * 5^e * 2^e against (2m + 1) * 2^(k - 1)
+    int leftPow2 = exponent, rightPow2 = binaryExponent - 1;
+    if(exponent >= 0)
+        BigMultiplyPow5(&left, exponent);
+    else
+        BigMultiplyPow5(&right, -exponent);
+
+    if(leftPow2 > rightPow2)
+        BigShiftLeft(&left, leftPow2 - rightPow2);
+    else
+        BigShiftLeft(&right, rightPow2 - leftPow2);
+
+    return BigCompare(&left, &right);
+}
+
+static double NextUp(double value)
+{
+    return BitsToDouble(DoubleToBits(value) + 1);
+}
+
+static double NextDown(double value)
+{
+    return BitsToDouble(DoubleToBits(value) - 1);
+}
+
+static int IsOdd(double value)
+{
+    return DoubleToBits(value) & 1;
+}
+
+// Corrects an estimate that is off by a few units in the last place to the correctly rounded value
+static double ParseExact(const Decimal *decimal, double estimate)
+{
+    Big digits;
+    int exponent;
+    BigFromDecimal(&digits, decimal, &exponent);
+
+    double value = estimate;
+    while(1)
+    {
+        int upper = CompareToMidpoint(&digits, exponent, value);
+        if(upper > 0 || (upper == 0 && IsOdd(value)))
+        {
+            value = NextUp(value);
+            if(value > DBL_MAX)
+                return value;
+            continue;
+        }
+
+        if(value == 0)
+            return value;
+
+        double below = NextDown(value);
+        int lower = CompareToMidpoint(&digits, exponent, below);
+        if(lower < 0 || (lower == 0 && IsOdd(value)))
+        {
+            value = below;
+            continue;
+        }
+
+        return value;
+    }
+}
+
+// Multiplies by the cached powers of ten and tracks the error in eighths of the last bit, 
+// which fails if the result could lie on either side of the halfway point between two doubles
+static int ParseApproximate(uint64_t significand, int exponent, int truncated, double *result)
+{
+    static const DiyFp SmallPowers[] = 
+    {
+        {0xa000000000000000u, -60}, {0xc800000000000000u, -57}, {0xfa00000000000000u, -54}, {0x9c40000000000000u, -50},
+        {0xc350000000000000u, -47}, {0xf424000000000000u, -44}, {0x9896800000000000u, -40}
+    };
+    const int ulpShift = 3, ulp = 1 << ulpShift;
+
+    DiyFp value = DiyFpNormalize((DiyFp){significand, 0});
+    int64_t error = truncated ? (int64_t)ulp << -value.E : 0;
+
+    unsigned index = (unsigned)(exponent + 348) / 8;
+    int adjustment = exponent - (-348 + (int)index * 8);
+    if(adjustment != 0)
+    {
+        value = DiyFpMultiply(value, SmallPowers[adjustment - 1]);
+
+        // The product only fits into 64 bits while there are few enough digits
+        if(CountDigits64(significand) + adjustment > MaxParsedDigits)
+            error += ulp / 2;
+    }
+
+    value = DiyFpMultiply(value, CachedPowers[index]);
+    error += ulp + (error == 0 ? 0 : 1);
+
+    int oldExponent = value.E;
+    value = DiyFpNormalize(value);
+    error <<= oldExponent - value.E;
+
+    // Subnormals have fewer significant bits, values below half of the smallest one are left to the exact comparison
+    int order = 64 + value.E;
+    if(order < -1074)
+    {
+        *result = 0;
+        return 0;
+    }
+
+    int significandSize = order >= -1021 ? 53 : order <= -1074 ? 0 : order + 1074;
+    int precision = 64 - significandSize;
+    if(precision + ulpShift >= 64)
+    {
+        int scale = precision + ulpShift - 63;
+        value.F >>= scale;
+        value.E += scale;
+        error = (error >> scale) + 1 + ulp;
+        precision -= scale;
+    }
+
+    uint64_t rounded = value.F >> precision;
+    int roundedExponent = value.E + precision;
+    uint64_t precisionBits = (value.F & (((uint64_t)1 << precision) - 1)) * ulp;
+    uint64_t halfway = ((uint64_t)1 << (precision - 1)) * ulp;
+
+    if(precisionBits >= halfway + (uint64_t)error)
+    {
+        rounded++;
+        if(rounded & ((uint64_t)1 << (SignificandBits + 1)))
+        {
+            rounded >>= 1;
+            roundedExponent++;
+        }
+    }
+
+    // Results outside of the exponent range are left to the exact comparison
+    int biased = roundedExponent == 1 - ExponentBias && !(rounded & ((uint64_t)1 << SignificandBits)) ? 0 : roundedExponent + ExponentBias;
+    if(biased < 0 || biased >= 0x7FF)
+    {
+        *result = biased < 0 ? 0 : DBL_MAX;
+        return 0;
+    }
+
+    *result = BitsToDouble((rounded & (((uint64_t)1 << SignificandBits) - 1)) | (uint64_t)biased << SignificandBits);
+    return halfway - (uint64_t)error >= precisionBits || precisionBits >= halfway + (uint64_t)error;
+}
+
+size_t INIParseFloat(const char *string, size_t length, double *value)
+{
+    const char *end = string + length;
+    const char *position = string;
+    int negative = 0;
+
+    if(position < end && (*position == '-' || *position == '+'))
+        negative = *position++ == '-';
+
+    Decimal decimal = {NULL, 0, 0};
+    uint64_t significand = 0;
+    size_t parsedDigits = 0;
+    int pointSeen = 0, anyDigits = 0;
+
+    for(; position < end; position++)
+    {
+        if(*position == '.' && !pointSeen)
+        {
+            pointSeen = 1;
+            continue;
+        }
+
+        unsigned digit = (unsigned char)*position - '0';
+        if(digit > 9)
+            break;
+
+        anyDigits = 1;
+
+        // Leading zeros only move the decimal point
+        if(digit == 0 && decimal.DigitCount == 0)
+        {
+            if(pointSeen)
+                decimal.Exponent--;
+            continue;
+        }
+
+        if(decimal.DigitCount == 0)
+            decimal.Digits = position;
+
+        if(parsedDigits < MaxParsedDigits)
+        {
+            significand = significand * 10 + digit;
+            parsedDigits++;
+        }
+
+        decimal.DigitCount++;
+        if(pointSeen)
+            decimal.Exponent--;
+    }
+
+    if(!anyDigits)
+        return 0;
+
+    if(position < end && (*position == 'e' || *position == 'E'))
+    {
+        const char *exponentStart = position + 1;
+        int exponentNegative = 0;
+
+        if(exponentStart < end && (*exponentStart == '-' || *exponentStart == '+'))
+            exponentNegative = *exponentStart++ == '-';
+
+        if(exponentStart < end && (unsigned)(*exponentStart - '0') <= 9)
+        {
+            int exponent = 0;
+            for(position = exponentStart; position < end && (unsigned)(*position - '0') <= 9; position++)
+            {
+                // Saturates far beyond the range of doubles
+                if(exponent < 100000)
+                    exponent = exponent * 10 + (*position - '0');
+            }
+
+            decimal.Exponent += exponentNegative ? -exponent : exponent;
+        }
+    }
+
+    double result;
+    long magnitude = (long)decimal.DigitCount + decimal.Exponent;
+    int significandExponent = decimal.Exponent + (int)(decimal.DigitCount - parsedDigits);
+
+    if(decimal.DigitCount == 0 || magnitude < -324)
+        result = 0;
+    else if(magnitude > 310)
+        result = HUGE_VAL;
+#if FLT_EVAL_METHOD == 0
+    // Both the significand and the power of ten are exact, so a single rounding gives the correct result
+    else if(parsedDigits == decimal.DigitCount && significand <= ((uint64_t)1 << 53) && significandExponent >= -MaxFastExponent && significandExponent <= MaxFastExponent)
+        result = significandExponent >= 0 ? (double)significand * ExactPowersOfTen[significandExponent] : (double)significand / ExactPowersOfTen[-significandExponent];
+#endif
+    else if(!ParseApproximate(significand, significandExponent, parsedDigits != decimal.DigitCount, &result))
+        result = ParseExact(&decimal, result);
+
+    *value = negative ? -result : result;
+    return position - string;
+}
@@ -0,0 +1,154 @@
+#include "INIInternal.h"
+#include "Assert.h"
+#include "Try.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+// Epoch based reclamation, readers announce the epoch they entered in and publishing waits for every reader of an older epoch
+
+enum HandleConstants
+{
+    CacheLineSize = 64
+};
+
+// Each reader has its own cache line, holding the epoch it entered in or 0 while it holds no INI
+typedef struct INIReaderSlot
+{
+    _Alignas(CacheLineSize) atomic_uint_fast64_t Epoch;
+} INIReaderSlot;
+
+struct INIHandle
+{
+    _Atomic(INI *) Current;
+    atomic_uint_fast64_t Epoch;
+    atomic_flag Publishing;
+
+    INIReaderSlot *Readers;
+    size_t ReaderCount;
+    void *ReadersAllocation;
+};
+
+static void INIHandleYield()
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+static void INIHandleFreeINI(INI *INI)
+{
+    if(INI == NULL)
+        return;
+
+    INIFree(INI);
+    free(INI);
+}
+
+INIHandle *INIHandleCreate(size_t readerCount)
+{
+    Assert(readerCount > 0, EINVAL, NULL);
+
+    INIHandle *handle;
+    TryNotNull(handle = malloc(sizeof(*handle)), NULL);
+
+    // Slots are aligned by hand, as malloc only aligns for the basic types
+    void *allocation;
+    TryNotNull(allocation = malloc((readerCount + 1) * sizeof(INIReaderSlot)), NULL, free(handle););
+
+    handle->ReadersAllocation = allocation;
+    handle->Readers = (INIReaderSlot *)(((uintptr_t)allocation + CacheLineSize - 1) & ~(uintptr_t)(CacheLineSize - 1));
+    handle->ReaderCount = readerCount;
+
+    for(size_t x = 0; x < readerCount; x++)
+        atomic_init(&handle->Readers[x].Epoch, 0);
+
+    atomic_init(&handle->Current, NULL);
+    atomic_init(&handle->Epoch, 1);
+    atomic_flag_clear(&handle->Publishing);
+
+    return handle;
+}
+
+void INIHandleFree(INIHandle *handle)
+{
+    Assert(handle, EINVAL, );
+
+    INIHandleFreeINI(atomic_load(&handle->Current));
+    free(handle->ReadersAllocation);
+    free(handle);
+}
+
+INI *INIHandleAcquire(INIHandle *handle, size_t reader)
+{
+    Assert(handle, EINVAL, NULL);
+    Assert(reader < handle->ReaderCount, EINVAL, NULL);
+
+    // The announcement has to be visible before the INI is loaded, which sequentially consistent ordering guarantees
+    atomic_store(&handle->Readers[reader].Epoch, atomic_load(&handle->Epoch));
+    return atomic_load(&handle->Current);
+}
+
+void INIHandleRelease(INIHandle *handle, size_t reader)
+{
+    Assert(handle, EINVAL, );
+    Assert(reader < handle->ReaderCount, EINVAL, );
+
+    atomic_store_explicit(&handle->Readers[reader].Epoch, 0, memory_order_release);
+}
+
+int INIHandlePublish(INIHandle *handle, INI *INI)
+{
+    Assert(handle, EINVAL, -1);
+    Assert(INI, EINVAL, -1);
+
+    // Readers share the INI, so nothing may be left for them to convert on their first read
+    INIDecodeValues(INI);
+
+    while(atomic_flag_test_and_set_explicit(&handle->Publishing, memory_order_acquire))
+        INIHandleYield();
+
+    struct INI *previous = atomic_exchange(&handle->Current, INI);
+    uint_fast64_t epoch = atomic_fetch_add(&handle->Epoch, 1) + 1;
+
+    // Readers that announced an older epoch may still hold the previous INI, later ones can only see the new one
+    for(size_t x = 0; x < handle->ReaderCount; x++)
+    {
+        while(1)
+        {
+            uint_fast64_t readerEpoch = atomic_load(&handle->Readers[x].Epoch);
+            if(readerEpoch == 0 || readerEpoch >= epoch)
+                break;
+
+            INIHandleYield();
+        }
+    }
+
+    atomic_flag_clear_explicit(&handle->Publishing, memory_order_release);
+
+    INIHandleFreeINI(previous);
+    return 0;
+}
+
+int INIHandleLoad(INIHandle *handle, char *file)
+{
+    Assert(handle, EINVAL, -1);
+    Assert(file, EINVAL, -1);
+
+    INI *INI;
+    TryNotNull(INI = malloc(sizeof(*INI)), -1);
+    *INI = INIDefault;
+
+    Try(INIRead(INI, file), -1, INIHandleFreeINI(INI););
+    Try(INIHandlePublish(handle, INI), -1, INIHandleFreeINI(INI););
+
+    return 0;
+}
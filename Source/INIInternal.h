@@ -0,0 +1,26 @@
+#ifndef ___INI_INTERNAL___
+#define ___INI_INTERNAL___
+
+// Shared by the sources of the library but not part of its interface
+#include "INIAccess.h"
+
+enum InternalConstants
+{
+    FallbackNameSize = 64
+};
+
+// FNV-1a, as the index and the frozen tables hash names
+uint32_t INIHash(const char *string, size_t length);
+// Hashes whole words at a time, for checksums of binary images and of files the watcher reads
+uint64_t INIChecksum(const char *data, size_t size);
+// Succeeds only if the whole string is a decimal integer that fits into an int64_t
+int INIParseInt(const char *string, size_t length, int64_t *integer);
+// The name INIRead gives the section of a header that failed to parse or repeats one, counting such headers from 0
+void INIFallbackSectionName(char *name, size_t sectionParseFailCount);
+
+// Parses a whole file that is already in memory the way INIRead does, the INI keeps copies so the buffer may be freed afterwards
+int INIReadBuffer(INI *INI, char *buffer, size_t size);
+// Converts the floats an INI with lazy values has not converted yet, so reading it no longer writes to its pairs
+void INIDecodeValues(INI *INI);
+
+#endif
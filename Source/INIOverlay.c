@@ -0,0 +1,244 @@
+#include "INIAccess.h"
+#include "Assert.h"
+#include "Try.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum OverlayConstants
+{
+    CacheBaseCapacity = 64
+};
+
+typedef struct INIOverlayLayer
+{
+    INI *INI;
+    // The version of the INI the cache was filled at
+    uint64_t Version;
+} INIOverlayLayer;
+
+TypedefList(INIOverlayLayer, ListLayer);
+
+// Resolved pairs, the section name points into the INI the pair is from. Misses are not cached, as they would need copies of the names
+typedef struct INIOverlayEntry
+{
+    const char *Section;
+    INIPair *Pair;
+    uint32_t Hash;
+} INIOverlayEntry;
+
+struct INIOverlay
+{
+    ListLayer Layers;
+    INIOverlayEntry *Cache;
+    size_t CacheCount;
+    size_t CacheCapacity;
+};
+
+INIOverlay *INIOverlayCreate(void)
+{
+    INIOverlay *overlay;
+    TryNotNull(overlay = calloc(1, sizeof(*overlay)), NULL);
+
+    return overlay;
+}
+
+void INIOverlayFree(INIOverlay *overlay)
+{
+    Assert(overlay, EINVAL, );
+
+    ListFree(&overlay->Layers);
+    free(overlay->Cache);
+    free(overlay);
+}
+
+static void INIOverlayClearCache(INIOverlay *overlay)
+{
+    if(overlay->Cache != NULL)
+        memset(overlay->Cache, 0, overlay->CacheCapacity * sizeof(*overlay->Cache));
+    overlay->CacheCount = 0;
+}
+
+int INIOverlayAdd(INIOverlay *overlay, INI *INI)
+{
+    Assert(overlay, EINVAL, -1);
+    Assert(INI, EINVAL, -1);
+
+    INIOverlayLayer layer = {INI, INI->Version};
+    Try(ListAdd(&overlay->Layers, &layer), -1);
+
+    // The new INI may hide pairs that are cached already
+    INIOverlayClearCache(overlay);
+    return 0;
+}
+
+// Drops the cache once any INI changed since it was filled, which may have moved or freed the cached pairs
+static void INIOverlayCheckVersions(INIOverlay *overlay)
+{
+    int changed = 0;
+    for(size_t x = 0; x < overlay->Layers.Count; x++)
+    {
+        INIOverlayLayer *layer = overlay->Layers.V + x;
+        if(layer->Version != layer->INI->Version)
+        {
+            layer->Version = layer->INI->Version;
+            changed = 1;
+        }
+    }
+
+    if(changed)
+        INIOverlayClearCache(overlay);
+}
+
+static uint32_t INIOverlayHash(const INIKey *sectionKey, const INIKey *pairKey)
+{
+    return (sectionKey->Hash * 16777619u) ^ pairKey->Hash;
+}
+
+static INIPair *INIOverlayCacheFind(INIOverlay *overlay, uint32_t hash, const char *sectionName, const char *key)
+{
+    if(overlay->CacheCount == 0)
+        return NULL;
+
+    size_t mask = overlay->CacheCapacity - 1;
+    for(size_t x = hash & mask; overlay->Cache[x].Pair != NULL; x = (x + 1) & mask)
+    {
+        INIOverlayEntry *entry = overlay->Cache + x;
+        if(entry->Hash == hash && strcmp(entry->Section, sectionName) == 0 && strcmp(entry->Pair->Key, key) == 0)
+            return entry->Pair;
+    }
+
+    return NULL;
+}
+
+static void INIOverlayCacheInsert(INIOverlayEntry *cache, size_t capacity, INIOverlayEntry entry)
+{
+    size_t x = entry.Hash & (capacity - 1);
+    while(cache[x].Pair != NULL)
+        x = (x + 1) & (capacity - 1);
+
+    cache[x] = entry;
+}
+
+// Running out of memory only means the pair is not cached
+static void INIOverlayCacheAdd(INIOverlay *overlay, uint32_t hash, const char *sectionName, INIPair *pair)
+{
+    if((overlay->CacheCount + 1) * 2 > overlay->CacheCapacity)
+    {
+        size_t capacity = overlay->CacheCapacity != 0 ? overlay->CacheCapacity * 2 : CacheBaseCapacity;
+
+        INIOverlayEntry *cache = calloc(capacity, sizeof(*cache));
+        if(cache == NULL)
+            return;
+
+        for(size_t x = 0; x < overlay->CacheCapacity; x++)
+        {
+            if(overlay->Cache[x].Pair != NULL)
+                INIOverlayCacheInsert(cache, capacity, overlay->Cache[x]);
+        }
+
+        free(overlay->Cache);
+        overlay->Cache = cache;
+        overlay->CacheCapacity = capacity;
+    }
+
+    INIOverlayCacheInsert(overlay->Cache, overlay->CacheCapacity, (INIOverlayEntry){sectionName, pair, hash});
+    overlay->CacheCount++;
+}
+
+// Looks through the bottom layerCount INIs, topmost first. Pairs whose value failed to parse are passed over like INIFlatten does
+static INIPair *INIOverlayFindBelow(INIOverlay *overlay, size_t layerCount, const INIKey *sectionKey, const INIKey *pairKey, INISection **foundSection)
+{
+    for(size_t x = layerCount; x-- > 0;)
+    {
+        INISection *section = INIFindSectionByKey(overlay->Layers.V[x].INI, sectionKey);
+        INIPair *pair = section != NULL ? INIFindPairByKey(section, pairKey) : NULL;
+
+        if(pair != NULL && pair->Type != INITypeInvalid)
+        {
+            if(foundSection != NULL)
+                *foundSection = section;
+            return pair;
+        }
+    }
+
+    return NULL;
+}
+
+INIPair *INIOverlayFindPair(INIOverlay *overlay, char *sectionName, char *key)
+{
+    Assert(overlay, EINVAL, NULL);
+    Assert(sectionName, EINVAL, NULL);
+    Assert(key, EINVAL, NULL);
+
+    INIOverlayCheckVersions(overlay);
+
+    INIKey sectionKey = INIKeyMake(sectionName), pairKey = INIKeyMake(key);
+    uint32_t hash = INIOverlayHash(&sectionKey, &pairKey);
+
+    INIPair *pair = INIOverlayCacheFind(overlay, hash, sectionName, key);
+    if(pair != NULL)
+        return pair;
+
+    INISection *section;
+    pair = INIOverlayFindBelow(overlay, overlay->Layers.Count, &sectionKey, &pairKey, &section);
+    if(pair != NULL)
+        INIOverlayCacheAdd(overlay, hash, section->Name, pair);
+
+    return pair;
+}
+
+void *INIOverlayFindValue(INIOverlay *overlay, char *sectionName, char *key, enum INIType type)
+{
+    INIPair *pair = INIOverlayFindPair(overlay, sectionName, key);
+    return pair ? INIGetValue(pair, type) : NULL;
+}
+
+char *INIOverlayFindString(INIOverlay *overlay, char *sectionName, char *key)
+{
+    return INIOverlayFindValue(overlay, sectionName, key, INITypeString);
+}
+
+int64_t *INIOverlayFindInt(INIOverlay *overlay, char *sectionName, char *key)
+{
+    return INIOverlayFindValue(overlay, sectionName, key, INITypeInt);
+}
+
+double *INIOverlayFindFloat(INIOverlay *overlay, char *sectionName, char *key)
+{
+    return INIOverlayFindValue(overlay, sectionName, key, INITypeFloat);
+}
+
+// The section of the target is the set of keys taken so far, which the layers above all won
+static int INIFlattenSection(INI *INI, INISection *section)
+{
+    INISection *target = INIFindSection(INI, section->Name);
+    if(target == NULL)
+        TryNotNull(target = INIAddSection(INI, section->Name), -1);
+
+    for(INIPair *pair = section->FirstPair; pair != NULL; pair = pair->NextPair)
+    {
+        // Values that failed to parse have nothing to copy, so a layer below may still give the key
+        if(pair->Type == INITypeInvalid || INIFindPair(target, pair->Key) != NULL)
+            continue;
+
+        TryNotNull(INIAddValue(INI, target, pair->Key, pair->Type, INIGetValue(pair, pair->Type)), -1);
+    }
+
+    return 0;
+}
+
+int INIFlatten(INIOverlay *overlay, INI *INI)
+{
+    Assert(overlay, EINVAL, -1);
+    Assert(INI, EINVAL, -1);
+    AssertMsg(INI->FirstSection == NULL, EINVAL, -1, "Overlays can only be flattened into an empty INI");
+
+    for(size_t x = overlay->Layers.Count; x-- > 0;)
+    {
+        struct INI *layer = overlay->Layers.V[x].INI;
+        for(INISection *section = layer->FirstSection; section != NULL; section = ININextSection(layer, section))
+            Try(INIFlattenSection(INI, section), -1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,406 @@
+#include "INIAccess.h"
+#include "INIInternal.h"
+#include "Assert.h"
+#include "Try.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+enum WatcherConstants
+{
+    LoadBufferSize = 1 << 16,
+    PollInterval = 100
+};
+
+typedef struct INISubscription
+{
+    char *Section;
+    char *Key;
+    INIChangeCallback Callback;
+    void *Context;
+} INISubscription;
+
+TypedefList(INISubscription, ListSubscription);
+
+struct INIWatcher
+{
+    char *File;
+    INIHandle *Handle;
+    INI *Current;
+    uint64_t Hash;
+    ListSubscription Subscriptions;
+    int Changes;
+
+#ifdef __linux__
+    int Notify;
+    const char *FileName;
+#else
+    time_t Time;
+    off_t Size;
+#endif
+};
+
+static void INIWatcherFreeINI(INI *INI)
+{
+    if(INI == NULL)
+        return;
+
+    INIFree(INI);
+    free(INI);
+}
+
+// Reads the whole file into one buffer, which is hashed and parsed, returns 1 when the file is missing
+static int INIWatcherLoad(const char *fileName, char **data, size_t *size)
+{
+    FILE *file = fopen(fileName, "rb");
+    if(file == NULL && errno == ENOENT)
+        return 1;
+
+    Assert(file != NULL, errno, -1);
+
+    size_t capacity = LoadBufferSize, used = 0;
+    char *buffer;
+    TryNotNull(buffer = malloc(capacity), -1, fclose(file););
+
+    size_t read;
+    while((read = fread(buffer + used, 1, capacity - used, file)) != 0)
+    {
+        used += read;
+        if(used < capacity)
+            continue;
+
+        char *grown;
+        TryNotNull(grown = realloc(buffer, capacity * 2), -1, free(buffer); fclose(file););
+        buffer = grown;
+        capacity *= 2;
+    }
+
+    int failed = ferror(file);
+    fclose(file);
+
+    AssertDo(!failed, EIO, free(buffer); return -1;);
+    *data = buffer;
+    *size = used;
+    return 0;
+}
+
+static INI *INIWatcherRead(char *data, size_t size)
+{
+    INI *INI;
+    TryNotNull(INI = malloc(sizeof(*INI)), NULL);
+    *INI = INIDefault;
+
+    // The index makes the diff a lookup per key instead of a scan. The buffer is copied rather than parsed in place,
+    // as it is freed while the INI is still in use
+    Try(INIEnableIndex(INI), NULL, INIWatcherFreeINI(INI););
+    Try(INIReadBuffer(INI, data, size), NULL, INIWatcherFreeINI(INI););
+
+    return INI;
+}
+
+INIWatcher *INIWatcherCreate(char *file, INIHandle *handle)
+{
+    Assert(file, EINVAL, NULL);
+
+    INIWatcher *watcher;
+    TryNotNull(watcher = calloc(1, sizeof(*watcher)), NULL);
+#ifdef __linux__
+    watcher->Notify = -1;
+#endif
+
+    TryNotNull(watcher->File = malloc(strlen(file) + 1), NULL, free(watcher););
+    strcpy(watcher->File, file);
+
+    char *data;
+    size_t size;
+    int missing;
+    Try(missing = INIWatcherLoad(file, &data, &size), NULL, INIWatcherFree(watcher););
+    AssertDo(!missing, ENOENT, INIWatcherFree(watcher); return NULL;);
+
+    watcher->Hash = INIChecksum(data, size);
+    watcher->Current = INIWatcherRead(data, size);
+    free(data);
+    TryNotNull(watcher->Current, NULL, INIWatcherFree(watcher););
+
+#ifdef __linux__
+    // The directory is watched, as editors often replace the file instead of writing to it
+    char *slash = strrchr(watcher->File, '/');
+    watcher->FileName = slash != NULL ? slash + 1 : watcher->File;
+
+    watcher->Notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    AssertDo(watcher->Notify >= 0, errno, INIWatcherFree(watcher); return NULL;);
+
+    if(slash != NULL)
+        *slash = '\0';
+    int watch = inotify_add_watch(watcher->Notify, slash != NULL ? (*watcher->File != '\0' ? watcher->File : "/") : ".", IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if(slash != NULL)
+        *slash = '/';
+
+    AssertDo(watch >= 0, errno, INIWatcherFree(watcher); return NULL;);
+#else
+    struct stat status;
+    AssertDo(stat(file, &status) == 0, errno, INIWatcherFree(watcher); return NULL;);
+    watcher->Time = status.st_mtime;
+    watcher->Size = status.st_size;
+#endif
+
+    // The handle owns the INI from here on
+    if(handle != NULL)
+    {
+        Try(INIHandlePublish(handle, watcher->Current), NULL, INIWatcherFree(watcher););
+        watcher->Handle = handle;
+    }
+
+    return watcher;
+}
+
+void INIWatcherFree(INIWatcher *watcher)
+{
+    Assert(watcher, EINVAL, );
+
+#ifdef __linux__
+    if(watcher->Notify >= 0)
+        close(watcher->Notify);
+#endif
+
+    for(size_t x = 0; x < watcher->Subscriptions.Count; x++)
+    {
+        free(watcher->Subscriptions.V[x].Section);
+        free(watcher->Subscriptions.V[x].Key);
+    }
+
+    // A published INI belongs to the handle
+    if(watcher->Handle == NULL)
+        INIWatcherFreeINI(watcher->Current);
+
+    ListFree(&watcher->Subscriptions);
+    free(watcher->File);
+    free(watcher);
+}
+
+INI *INIWatcherINI(INIWatcher *watcher)
+{
+    Assert(watcher, EINVAL, NULL);
+
+    return watcher->Current;
+}
+
+static char *INIWatcherCopyName(const char *name)
+{
+    if(name == NULL)
+        return NULL;
+
+    char *copy;
+    TryNotNull(copy = malloc(strlen(name) + 1), NULL);
+    return strcpy(copy, name);
+}
+
+int INIWatcherSubscribe(INIWatcher *watcher, char *section, char *key, INIChangeCallback callback, void *context)
+{
+    Assert(watcher, EINVAL, -1);
+    Assert(callback, EINVAL, -1);
+
+    INISubscription subscription = {NULL, NULL, callback, context};
+    AssertDo(section == NULL || (subscription.Section = INIWatcherCopyName(section)) != NULL, ENOMEM, return -1;);
+    AssertDo(key == NULL || (subscription.Key = INIWatcherCopyName(key)) != NULL, ENOMEM, free(subscription.Section); return -1;);
+    Try(ListAdd(&watcher->Subscriptions, &subscription), -1, free(subscription.Section); free(subscription.Key););
+
+    return 0;
+}
+
+static int INIPairEquals(const INIPair *a, const INIPair *b)
+{
+    if(a->Type != b->Type || strcmp(a->Key, b->Key) != 0)
+        return 0;
+
+    switch(a->Type)
+    {
+        case INITypeString:
+            return strcmp(a->Value, b->Value) == 0;
+        case INITypeInt:
+            return a->Int == b->Int;
+        case INITypeFloat:
+            return memcmp(&a->Float, &b->Float, sizeof(a->Float)) == 0;
+        default:
+            return 1;
+    }
+}
+
+static void INIWatcherNotify(INIWatcher *watcher, enum INIChange change, const char *section, INIPair *oldPair, INIPair *newPair)
+{
+    const char *key = oldPair != NULL ? oldPair->Key : newPair->Key;
+    watcher->Changes++;
+
+    for(size_t x = 0; x < watcher->Subscriptions.Count; x++)
+    {
+        INISubscription *subscription = watcher->Subscriptions.V + x;
+        if((subscription->Section == NULL || strcmp(subscription->Section, section) == 0) && (subscription->Key == NULL || strcmp(subscription->Key, key) == 0))
+            subscription->Callback(subscription->Context, change, section, oldPair, newPair);
+    }
+}
+
+// Sections are compared pair by pair in order first, which settles unchanged sections without any lookups
+static int INISectionUnchanged(const INISection *oldSection, const INISection *newSection)
+{
+    const INIPair *oldPair = oldSection->FirstPair, *newPair = newSection->FirstPair;
+    for(; oldPair != NULL && newPair != NULL; oldPair = oldPair->NextPair, newPair = newPair->NextPair)
+    {
+        if(!INIPairEquals(oldPair, newPair))
+            return 0;
+    }
+
+    return oldPair == NULL && newPair == NULL;
+}
+
+static void INIWatcherDiff(INIWatcher *watcher, INI *oldINI, INI *newINI)
+{
+    for(INISection *newSection = newINI->FirstSection; newSection != NULL; newSection = newSection->NextSection)
+    {
+        INISection *oldSection = INIFindSection(oldINI, newSection->Name);
+        if(oldSection != NULL && INISectionUnchanged(oldSection, newSection))
+            continue;
+
+        for(INIPair *newPair = newSection->FirstPair; newPair != NULL; newPair = newPair->NextPair)
+        {
+            INIPair *oldPair = oldSection != NULL ? INIFindPair(oldSection, newPair->Key) : NULL;
+            if(oldPair == NULL)
+                INIWatcherNotify(watcher, INIChangeAdded, newSection->Name, NULL, newPair);
+            else if(!INIPairEquals(oldPair, newPair))
+                INIWatcherNotify(watcher, INIChangeModified, newSection->Name, oldPair, newPair);
+        }
+
+        if(oldSection == NULL)
+            continue;
+
+        for(INIPair *oldPair = oldSection->FirstPair; oldPair != NULL; oldPair = oldPair->NextPair)
+        {
+            if(INIFindPair(newSection, oldPair->Key) == NULL)
+                INIWatcherNotify(watcher, INIChangeRemoved, newSection->Name, oldPair, NULL);
+        }
+    }
+
+    for(INISection *oldSection = oldINI->FirstSection; oldSection != NULL; oldSection = oldSection->NextSection)
+    {
+        if(INIFindSection(newINI, oldSection->Name) != NULL)
+            continue;
+
+        for(INIPair *oldPair = oldSection->FirstPair; oldPair != NULL; oldPair = oldPair->NextPair)
+            INIWatcherNotify(watcher, INIChangeRemoved, oldSection->Name, oldPair, NULL);
+    }
+}
+
+int INIWatcherCheck(INIWatcher *watcher)
+{
+    Assert(watcher, EINVAL, -1);
+
+    // A file that is being replaced may be missing for a moment, which is not a change yet
+    char *data;
+    size_t size;
+    int missing;
+    Try(missing = INIWatcherLoad(watcher->File, &data, &size), -1);
+
+    if(missing)
+        return 0;
+
+    // Comparing the content means saving the file without changes does not cause a reload
+    uint64_t hash = INIChecksum(data, size);
+    INI *newINI = hash != watcher->Hash ? INIWatcherRead(data, size) : NULL;
+    free(data);
+
+    if(hash == watcher->Hash)
+        return 0;
+
+    TryNotNull(newINI, -1);
+
+    INI *oldINI = watcher->Current;
+    watcher->Changes = 0;
+    INIWatcherDiff(watcher, oldINI, newINI);
+
+    watcher->Current = newINI;
+    watcher->Hash = hash;
+
+    // Publishing frees the previous INI once its readers are done
+    if(watcher->Handle != NULL)
+    {
+        Try(INIHandlePublish(watcher->Handle, newINI), -1);
+    }
+    else
+        INIWatcherFreeINI(oldINI);
+
+    return watcher->Changes;
+}
+
+// Returns 1 once the file may have changed, 0 when the timeout ran out first
+static int INIWatcherWait(INIWatcher *watcher, int timeout)
+{
+#ifdef __linux__
+    struct pollfd descriptor = {watcher->Notify, POLLIN, 0};
+    int ready = poll(&descriptor, 1, timeout);
+    Assert(ready >= 0, errno, -1);
+
+    if(ready == 0)
+        return 0;
+
+    _Alignas(struct inotify_event) char buffer[4096];
+    int changed = 0;
+    ssize_t length;
+
+    while((length = read(watcher->Notify, buffer, sizeof(buffer))) > 0)
+    {
+        for(char *position = buffer; position < buffer + length;)
+        {
+            struct inotify_event *event = (struct inotify_event *)position;
+            if(event->len != 0 && strcmp(event->name, watcher->FileName) == 0)
+                changed = 1;
+
+            position += sizeof(*event) + event->len;
+        }
+    }
+
+    return changed;
+#else
+    // Without inotify the modification time and size are polled
+    for(int waited = 0; timeout < 0 || waited <= timeout; waited += PollInterval)
+    {
+        struct stat status;
+        if(stat(watcher->File, &status) == 0 && (status.st_mtime != watcher->Time || status.st_size != watcher->Size))
+        {
+            watcher->Time = status.st_mtime;
+            watcher->Size = status.st_size;
+            return 1;
+        }
+
+        if(timeout >= 0 && waited + PollInterval > timeout)
+            break;
+
+#ifdef _WIN32
+        Sleep(PollInterval);
+#else
+        struct timespec interval = {0, PollInterval * 1000000L};
+        nanosleep(&interval, NULL);
+#endif
+    }
+
+    return 0;
+#endif
+}
+
+int INIWatcherPoll(INIWatcher *watcher, int timeout)
+{
+    Assert(watcher, EINVAL, -1);
+
+    int changed;
+    Try(changed = INIWatcherWait(watcher, timeout), -1);
+
+    return changed ? INIWatcherCheck(watcher) : 0;
+}
@@ -1,4 +1,8 @@
 #include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
 #include "INIAccess.h"
 #include "TestingUtilities.h"
 #include "Try.h"
@@ -22,7 +26,1625 @@ void TestINIValidity(INI *INI)
     INIPair *secondPair = firstPair->NextPair;
     TEST(secondPair, !=, NULL);
     TEST(strcmp(secondPair->Key, "Number"), ==, 0);
-    TEST(*INIGetFloat(secondPair), ==, 1);
+    TEST(secondPair->Type, ==, INITypeInt, return;);
+    TEST(*INIGetInt(secondPair), ==, 1);
+    TEST(INIGetFloat(secondPair), ==, NULL);
+    double number = 0;
+    TEST(INIGetNumber(secondPair, &number), ==, 0);
+    TEST(number, ==, 1.0);
+    TEST(INIGetNumber(firstPair, &number), ==, -1);
+}
+
+void TestIndex()
+{
+    INI INI = INIDefault;
+    TEST(INIEnableIndex(&INI), ==, 0, ErrorCurrentPrint(););
+
+    char name[32];
+    for(int x = 0; x < 200; x++)
+    {
+        snprintf(name, sizeof(name), "Section%d", x);
+        INISection *section;
+        TEST((section = INIAddSection(&INI, name)), !=, NULL, ErrorCurrentPrint(); return;);
+
+        for(int y = 0; y < 20; y++)
+        {
+            snprintf(name, sizeof(name), "Key%d", y);
+            TEST(INIAddFloat(&INI, section, name, x * y), !=, NULL, ErrorCurrentPrint(); return;);
+        }
+    }
+
+    TEST(INIAddSection(&INI, "Section7"), ==, NULL);
+
+    INISection *section = INIFindSection(&INI, "Section123");
+    TEST(section, !=, NULL, return;);
+    TEST(strcmp(section->Name, "Section123"), ==, 0);
+    TEST(*INIFindFloat(section, "Key7"), ==, 123 * 7);
+    TEST(INIFindPair(section, "Key20"), ==, NULL);
+    TEST(INIAddFloat(&INI, section, "Key7", 0), ==, NULL);
+
+    TEST(INIFindAndRemovePair(section, "Key7"), ==, 0);
+    TEST(INIFindPair(section, "Key7"), ==, NULL);
+    TEST(INIAddFloat(&INI, section, "Key7", 1), !=, NULL);
+    TEST(strcmp(section->FirstPair->Key, "Key0"), ==, 0);
+
+    TEST(INIRemoveSection(&INI, section), ==, 0);
+    TEST(INIFindSection(&INI, "Section123"), ==, NULL);
+    TEST(INIFindSection(&INI, "Section124"), !=, NULL);
+
+    int sectionCount = 0;
+    for(INISection *iter = INI.FirstSection; iter != NULL; iter = iter->NextSection, sectionCount++)
+    {
+        snprintf(name, sizeof(name), "Section%d", sectionCount < 123 ? sectionCount : sectionCount + 1);
+        TEST(strcmp(iter->Name, name), ==, 0);
+    }
+    TEST(sectionCount, ==, 199);
+
+    INIFree(&INI);
+}
+
+void TestAppend()
+{
+    INI INI = INIDefault;
+    INISection *first, *second;
+    TEST((first = INIAddSection(&INI, "First")), !=, NULL, return;);
+    TEST((second = INIAddSection(&INI, "Second")), !=, NULL, return;);
+    TEST(INI.LastSection, ==, second);
+
+    TEST(INIRemoveSection(&INI, second), ==, 0);
+    TEST(INI.LastSection, ==, first);
+    TEST((second = INIAddSection(&INI, "Second")), !=, NULL, return;);
+    TEST(first->NextSection, ==, second);
+
+    INIPair *a, *b;
+    TEST((a = INIAddFloat(&INI, first, "A", 1)), !=, NULL, return;);
+    TEST((b = INIAddFloat(&INI, first, "B", 2)), !=, NULL, return;);
+    TEST(INIRemovePair(first, b), ==, 0);
+    TEST(first->LastPair, ==, a);
+    TEST(INIRemovePair(first, a), ==, 0);
+    TEST(first->LastPair, ==, NULL);
+    TEST((b = INIAddFloat(&INI, first, "B", 2)), !=, NULL, return;);
+    TEST(first->FirstPair, ==, b);
+
+    INIFree(&INI);
+}
+
+void TestStreamChunks()
+{
+    const char *text = 
+    "[First]\n"
+    "  Key = \"A value\"  \n"
+    "# Comment\n"
+    "\n"
+    "Number = 2.5\n"
+    "[Second]   \n"
+    "Last = \"End\"";
+    size_t length = strlen(text);
+
+    const size_t chunkSizes[] = {1, 2, 3, 7, 64};
+    for(size_t x = 0; x < sizeof(chunkSizes) / sizeof(*chunkSizes); x++)
+    {
+        INI INI = INIDefault;
+        INIStream stream = INIStreamDefault;
+
+        for(size_t offset = 0; offset < length; offset += chunkSizes[x])
+        {
+            stream.IOStream = (char *)text + offset;
+            stream.IOStreamCount = length - offset < chunkSizes[x] ? length - offset : chunkSizes[x];
+            TEST(INIStreamRead(&INI, &stream), ==, INIStreamStatusSuccess, ErrorCurrentPrint(););
+        }
+
+        stream.IOStreamCount = 0;
+        TEST(INIStreamRead(&INI, &stream), ==, INIStreamStatusSuccess, ErrorCurrentPrint(););
+        INIStreamFree(&stream);
+
+        INISection *first = INIFindSection(&INI, "First"), *second = INIFindSection(&INI, "Second");
+        TEST(first, !=, NULL, INIFree(&INI); continue;);
+        TEST(second, !=, NULL, INIFree(&INI); continue;);
+        TEST(strcmp(INIFindString(first, "Key"), "A value"), ==, 0);
+        TEST(*INIFindFloat(first, "Number"), ==, 2.5);
+        TEST(strcmp(INIFindString(second, "Last"), "End"), ==, 0);
+
+        INIFree(&INI);
+    }
+}
+
+void TestWriteChunks()
+{
+    const char *expected = 
+    "[First]\n"
+    "Key = \"A value\"\n"
+    "Number = 2.5\n"
+    "[Second]\n"
+    "Count = 12\n";
+    size_t length = strlen(expected);
+
+    INI INI = INIDefault;
+    INISection *first = INIAddSection(&INI, "First"), *second = INIAddSection(&INI, "Second");
+    INIAddString(&INI, first, "Key", "A value");
+    INIAddFloat(&INI, first, "Number", 2.5);
+    INIAddInt(&INI, second, "Count", 12);
+
+    // Lines that do not fit into the rest of a chunk have to continue in the next one
+    const size_t chunkSizes[] = {1, 2, 3, 7, 64};
+    for(size_t x = 0; x < sizeof(chunkSizes) / sizeof(*chunkSizes); x++)
+    {
+        char output[128];
+        size_t written = 0;
+        INIStream stream = INIStreamDefault;
+
+        while(1)
+        {
+            stream.IOStream = output + written;
+            stream.IOStreamCount = chunkSizes[x];
+
+            int code = INIStreamWrite(&INI, &stream);
+            written += chunkSizes[x] - stream.IOStreamCount;
+
+            if(code != INIStreamStatusContinue || written + chunkSizes[x] > sizeof(output))
+            {
+                TEST(code, ==, INIStreamStatusSuccess, ErrorCurrentPrint(););
+                break;
+            }
+        }
+
+        INIStreamFree(&stream);
+        TEST(written, ==, length);
+        TEST(memcmp(output, expected, length), ==, 0);
+    }
+
+    INIFree(&INI);
+}
+
+typedef struct TestEvents
+{
+    char Log[512];
+    size_t Used;
+    int StopAfter;
+} TestEvents;
+
+static int TestLogEvent(TestEvents *events, const char *format, const char *a, size_t aLength, const char *b, size_t bLength, int number)
+{
+    events->Used += snprintf(events->Log + events->Used, sizeof(events->Log) - events->Used, format, (int)aLength, a, (int)bLength, b, number);
+    return --events->StopAfter == 0;
+}
+
+static int TestSectionEvent(void *context, const char *name, size_t length)
+{
+    return TestLogEvent(context, "[%.*s%.*s]%d", name, length, "", 0, 0);
+}
+
+static int TestPairEvent(void *context, const char *key, size_t keyLength, const char *value, size_t valueLength, enum INIType type)
+{
+    return TestLogEvent(context, "%.*s=%.*s:%d;", key, keyLength, value, valueLength, type);
+}
+
+static int TestErrorEvent(void *context, enum INIStreamStatus status, const char *line, size_t length)
+{
+    return TestLogEvent(context, "!%.*s%.*s!%d;", line, length, "", 0, status);
+}
+
+void TestParse()
+{
+    const char *text = 
+    "Early = 1\n"
+    "[First]\n"
+    "  Key = \"A value\"  \n"
+    "# Comment\n"
+    "Broken = \"Open\n"
+    "Number = 2.5\n"
+    "[Second\n"
+    "[Second]   \n"
+    "Last = \"End\"";
+    const char *expected = "Early=1:3;[First]0Key=A value:1;!Broken = \"Open!3;Number=2.5:2;![Second!2;[Second]0Last=End:1;";
+    size_t length = strlen(text);
+
+    const size_t chunkSizes[] = {1, 2, 3, 7, 64};
+    for(size_t x = 0; x < sizeof(chunkSizes) / sizeof(*chunkSizes); x++)
+    {
+        TestEvents events = {.Used = 0, .StopAfter = -1};
+        INIHandlers handlers = {&events, TestSectionEvent, TestPairEvent, TestErrorEvent};
+        INIStream stream = INIStreamDefault;
+
+        for(size_t offset = 0; offset < length; offset += chunkSizes[x])
+        {
+            stream.IOStream = (char *)text + offset;
+            stream.IOStreamCount = length - offset < chunkSizes[x] ? length - offset : chunkSizes[x];
+            TEST(INIStreamParse(&stream, &handlers), ==, INIStreamStatusSuccess, ErrorCurrentPrint(););
+        }
+
+        stream.IOStreamCount = 0;
+        TEST(INIStreamParse(&stream, &handlers), ==, INIStreamStatusSuccess, ErrorCurrentPrint(););
+        INIStreamFree(&stream);
+        TEST(strcmp(events.Log, expected), ==, 0, printf("%s\n", events.Log););
+    }
+
+    // Stopping leaves the rest of the chunk for the next call
+    TestEvents events = {.Used = 0, .StopAfter = 2};
+    INIHandlers handlers = {&events, TestSectionEvent, TestPairEvent, NULL};
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = (char *)text;
+    stream.IOStreamCount = length;
+    TEST(INIStreamParse(&stream, &handlers), ==, INIStreamStatusStopped);
+    TEST(strcmp(events.Log, "Early=1:3;[First]0"), ==, 0, printf("%s\n", events.Log););
+    TEST(strncmp(stream.IOStream, "  Key", 5), ==, 0);
+    TEST(INIStreamParse(&stream, &handlers), ==, INIStreamStatusSuccess);
+    INIStreamFree(&stream);
+
+    events = (TestEvents){.Used = 0, .StopAfter = -1};
+    TEST(INIParse("Tests/TestINI.ini", &handlers), ==, INIStreamStatusSuccess, ErrorCurrentPrint(););
+    TEST(events.Used, >, 0);
+    TEST(INIParse("Tests/Missing.ini", &handlers), ==, INIStreamStatusFatalFailure);
+}
+
+void TestArena()
+{
+    INI INI = INIDefault;
+    _Alignas(max_align_t) char buffer[2048];
+    TEST(INIUseBuffer(&INI, buffer, sizeof(buffer)), ==, 0, ErrorCurrentPrint(););
+
+    INISection *section;
+    TEST((section = INIAddSection(&INI, "Section")), !=, NULL, return;);
+    TEST((char *)section >= buffer && (char *)section < buffer + sizeof(buffer), ==, 1);
+    TEST((uintptr_t)section % _Alignof(max_align_t), ==, 0);
+
+    char longString[5000];
+    memset(longString, 'a', sizeof(longString) - 1);
+    longString[sizeof(longString) - 1] = '\0';
+    TEST(INIAddString(&INI, section, "Long", longString), !=, NULL, return;);
+    TEST(INIAddFloat(&INI, section, "Number", 1), !=, NULL, return;);
+    TEST(strcmp(INIFindString(section, "Long"), longString), ==, 0);
+
+    TEST(INIEnableIndex(&INI), ==, 0);
+    TEST(INIReset(&INI), ==, 0, ErrorCurrentPrint(););
+    TEST(INI.FirstSection, ==, NULL);
+
+    TEST(INIRead(&INI, "Tests/TestINI.ini"), ==, 0, ErrorCurrentPrint(););
+    TestINIValidity(&INI);
+    TEST((char *)INI.FirstSection >= buffer && (char *)INI.FirstSection < buffer + sizeof(buffer), ==, 1);
+    TEST(INIFindSection(&INI, "Section"), ==, INI.FirstSection);
+
+    INIFree(&INI);
+}
+
+void TestNumbers()
+{
+    const char *text = 
+    "[Numbers]\n"
+    "Big = 9223372036854775807\n"
+    "Small = -9223372036854775808\n"
+    "Over = 9223372036854775808\n"
+    "Fraction = 1.5\n"
+    "Signed = +42\n";
+
+    INI INI = INIDefault;
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = (char *)text;
+    stream.IOStreamCount = strlen(text);
+    TEST(INIStreamRead(&INI, &stream), ==, INIStreamStatusSuccess, ErrorCurrentPrint(););
+    INIStreamFree(&stream);
+
+    INISection *section = INIFindSection(&INI, "Numbers");
+    TEST(section, !=, NULL, return;);
+    TEST(*INIFindInt(section, "Big"), ==, INT64_MAX);
+    TEST(*INIFindInt(section, "Small"), ==, INT64_MIN);
+    TEST(*INIFindFloat(section, "Over"), ==, 9223372036854775808.0);
+    TEST(*INIFindFloat(section, "Fraction"), ==, 1.5);
+    TEST(*INIFindInt(section, "Signed"), ==, 42);
+    TEST(INIFindFloat(section, "Signed"), ==, NULL);
+    double number = 0;
+    TEST(INIFindNumber(section, "Signed", &number), ==, 0);
+    TEST(number, ==, 42.0);
+    TEST(INIFindNumber(section, "Fraction", &number), ==, 0);
+    TEST(number, ==, 1.5);
+    TEST(INIFindNumber(section, "Missing", &number), ==, -1);
+
+    TEST(INIFindAndSetInt(&INI, section, "Fraction", 3), ==, 0);
+    TEST(*INIFindInt(section, "Fraction"), ==, 3);
+    TEST(INIFindAndSetFloat(&INI, section, "Big", 2), ==, 0);
+
+    // Floats with whole values have to stay floats when written and read again
+    TEST(INIWrite(&INI, "Bin/OutNumbers.ini"), ==, 0, ErrorCurrentPrint(););
+    INIFree(&INI);
+
+    TEST(INIRead(&INI, "Bin/OutNumbers.ini"), ==, 0, ErrorCurrentPrint(););
+    section = INIFindSection(&INI, "Numbers");
+    TEST(section, !=, NULL, return;);
+    TEST(*INIFindFloat(section, "Big"), ==, 2);
+    TEST(*INIFindInt(section, "Fraction"), ==, 3);
+    TEST(*INIFindInt(section, "Small"), ==, INT64_MIN);
+    INIFree(&INI);
+}
+
+static uint64_t TestRandom(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int TestFloatMatches(const char *string)
+{
+    double parsed, expected = strtod(string, NULL);
+    size_t length = strlen(string);
+    return INIParseFloat(string, length, &parsed) == length && memcmp(&parsed, &expected, sizeof(parsed)) == 0;
+}
+
+void TestFloats()
+{
+    char buffer[INIFloatBufferSize];
+    const double values[] = {0.1, 1, 123456, 0.001, 1e-5, 1e20, 5e-324, 1.7976931348623157e308, -2.5};
+    const char *expected[] = {"0.1", "1.0", "123456.0", "0.001", "0.00001", "1e20", "5e-324", "1.7976931348623157e308", "-2.5"};
+
+    for(size_t x = 0; x < sizeof(values) / sizeof(*values); x++)
+    {
+        INIFormatFloat(values[x], buffer);
+        TEST(strcmp(buffer, expected[x]), ==, 0, printf("%s\n", buffer););
+    }
+
+    // Halfway cases, the edges of the exponent range and inputs longer than the significand
+    const char *hard[] = {"9007199254740993", "2.2250738585072011e-308", "2.4703282292062327e-324", "2.4703282292062328e-324", 
+        "1.7976931348623158e308", "1.7976931348623159e308", "0.30000000000000004", "1e-400", "1e400", "7.3177701707893310e+15",
+        "123456789012345678901234567890e-20", "0.000000000000000000000000000000000000000000001e-280"};
+    for(size_t x = 0; x < sizeof(hard) / sizeof(*hard); x++)
+        TEST(TestFloatMatches(hard[x]), ==, 1, printf("%s\n", hard[x]););
+
+    uint64_t state = 88172645463325252u;
+    size_t formatFailures = 0, parseFailures = 0;
+
+    for(int x = 0; x < 100000; x++)
+    {
+        uint64_t bits = TestRandom(&state);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if(value != value || value - value != 0)
+            continue;
+
+        double parsed;
+        size_t length = INIFormatFloat(value, buffer);
+        if(INIParseFloat(buffer, length, &parsed) != length || memcmp(&parsed, &value, sizeof(value)) != 0 || !TestFloatMatches(buffer))
+            formatFailures++;
+
+        // Random decimals with up to 40 digits
+        char decimal[64];
+        int digits = 1 + TestRandom(&state) % 40;
+        for(int y = 0; y < digits; y++)
+            decimal[y] = '0' + TestRandom(&state) % 10;
+        snprintf(decimal + digits, sizeof(decimal) - digits, "e%d", (int)(TestRandom(&state) % 700) - 360);
+        if(!TestFloatMatches(decimal))
+            parseFailures++;
+    }
+
+    TEST(formatFailures, ==, 0);
+    TEST(parseFailures, ==, 0);
+}
+
+static void TestWriteText(const char *fileName, const char *text)
+{
+    FILE *file = fopen(fileName, "w");
+    TEST(file, !=, NULL, return;);
+    fputs(text, file);
+    fclose(file);
+}
+
+void TestBinary()
+{
+    const char *source = "Bin/BinarySource.ini", *image = "Bin/OutBinary.bin";
+    TestWriteText(source, INIString);
+
+    INI INI = INIDefault;
+    TEST(INIRead(&INI, (char *)source), ==, 0, ErrorCurrentPrint(););
+    INISection *section = INIAddSection(&INI, "Numbers");
+    INIAddFloat(&INI, section, "Float", 0.25);
+    INIAddInt(&INI, section, "Int", -7);
+    TEST(INISaveBinary(&INI, (char *)image, (char *)source), ==, 0, ErrorCurrentPrint(););
+    INIFree(&INI);
+
+    TEST(INIEnableIndex(&INI), ==, 0);
+    TEST(INILoadBinary(&INI, (char *)image, (char *)source), ==, 0, ErrorCurrentPrint(););
+    TestINIValidity(&INI);
+    TEST((section = INIFindSection(&INI, "Numbers")), !=, NULL, return;);
+    TEST(section->Owner, ==, &INI);
+    TEST(INI.LastSection, ==, section);
+    TEST(*INIFindFloat(section, "Float"), ==, 0.25);
+    TEST(*INIFindInt(section, "Int"), ==, -7);
+
+    // Loaded INIs stay mutable
+    TEST(INIFindAndSetString(&INI, INI.FirstSection, "Key", "Changed"), ==, 0, ErrorCurrentPrint(););
+    TEST(strcmp(INIFindString(INI.FirstSection, "Key"), "Changed"), ==, 0);
+    TEST(INIAddInt(&INI, section, "Added", 1), !=, NULL);
+    TEST(INILoadBinary(&INI, (char *)image, NULL), ==, -1);
+    INIFree(&INI);
+
+    // A changed source makes the image stale
+    TestWriteText(source, "[Other]\nKey = 2\n");
+    TEST(INILoadBinary(&INI, (char *)image, (char *)source), ==, 1, ErrorCurrentPrint(););
+    TEST(INIFindSection(&INI, "Other"), !=, NULL);
+    TEST(INIFindSection(&INI, "Numbers"), ==, NULL);
+    INIFree(&INI);
+
+    // So does a corrupted image
+    FILE *file = fopen(image, "r+b");
+    TEST(file, !=, NULL, return;);
+    fseek(file, -3, SEEK_END);
+    fputc('!', file);
+    fclose(file);
+
+    TEST(INILoadBinary(&INI, (char *)image, NULL), ==, -1);
+    TEST(INILoadBinary(&INI, (char *)image, (char *)source), ==, 1, ErrorCurrentPrint(););
+    TEST(INIFindSection(&INI, "Other"), !=, NULL);
+    INIFree(&INI);
+}
+
+void TestFreeze()
+{
+    INI INI = INIDefault;
+    INIStats stats;
+    char name[32];
+    int counted = INIEnableStats(&INI) == 0;
+
+    for(int x = 0; x < 100; x++)
+    {
+        snprintf(name, sizeof(name), "Section%d", x);
+        INISection *section;
+        TEST((section = INIAddSection(&INI, name)), !=, NULL, ErrorCurrentPrint(); return;);
+
+        for(int y = 0; y < x % 13; y++)
+        {
+            snprintf(name, sizeof(name), "Key%d", y);
+            TEST(INIAddInt(&INI, section, name, x * y), !=, NULL, ErrorCurrentPrint(); return;);
+        }
+    }
+    INIAddString(&INI, INI.FirstSection, "String", "Value");
+    if(counted)
+    {
+        TEST(INIGetStats(&INI, &stats), ==, 0);
+        TEST(stats.ArenaBlocks, >, 1);
+    }
+
+    TEST(INIFreeze(&INI), ==, 0, ErrorCurrentPrint(););
+    TEST(INI.Frozen, !=, NULL, return;);
+
+    // Everything moved into the frozen block, so only the first arena block is kept
+    if(counted)
+    {
+        TEST(INIGetStats(&INI, &stats), ==, 0);
+        TEST(stats.ArenaBlocks, ==, 1);
+        TEST(stats.ArenaUsed, ==, 0);
+    }
+
+    // Iteration keeps the original order and walks through memory linearly
+    int sectionCount = 0;
+    for(INISection *section = INI.FirstSection; section != NULL; section = section->NextSection, sectionCount++)
+    {
+        snprintf(name, sizeof(name), "Section%d", sectionCount);
+        TEST(strcmp(section->Name, name), ==, 0);
+        TEST(section->FirstPair == NULL || (void *)section->FirstPair == (void *)(section + 1), ==, 1);
+        TEST(section->NextSection == NULL || section->NextSection > section, ==, 1);
+    }
+    TEST(sectionCount, ==, 100);
+    TEST(strcmp(INI.LastSection->Name, "Section99"), ==, 0);
+
+    for(int x = 0; x < 100; x++)
+    {
+        snprintf(name, sizeof(name), "Section%d", x);
+        INISection *section;
+        TEST((section = INIFindSection(&INI, name)), !=, NULL, continue;);
+
+        for(int y = 0; y < x % 13; y++)
+        {
+            snprintf(name, sizeof(name), "Key%d", y);
+            int64_t *value = INIFindInt(section, name);
+            TEST(value, !=, NULL, continue;);
+            TEST(*value, ==, x * y);
+        }
+
+        TEST(INIFindPair(section, "Key13"), ==, NULL);
+    }
+
+    TEST(INIFindSection(&INI, "Section100"), ==, NULL);
+    TEST(strcmp(INIFindString(INI.FirstSection, "String"), "Value"), ==, 0);
+
+    // Every change is refused
+    INISection *section = INIFindSection(&INI, "Section5");
+    TEST(INIAddSection(&INI, "New"), ==, NULL);
+    TEST(INIAddInt(&INI, section, "New", 1), ==, NULL);
+    TEST(INIFindAndSetInt(&INI, section, "Key1", 1), ==, -1);
+    TEST(INIFindAndRemovePair(section, "Key1"), ==, -1);
+    TEST(INIRemoveSection(&INI, section), ==, -1);
+    TEST(*INIFindInt(section, "Key1"), ==, 5);
+
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = "[New]\n";
+    stream.IOStreamCount = 6;
+    TEST(INIStreamRead(&INI, &stream), ==, INIStreamStatusFatalFailure);
+    INIStreamFree(&stream);
+
+    TEST(INIReset(&INI), ==, 0, ErrorCurrentPrint(););
+    TEST(INI.Frozen, ==, NULL);
+    TEST(INIAddSection(&INI, "New"), !=, NULL, ErrorCurrentPrint(););
+    INIFree(&INI);
+}
+
+void TestKeys()
+{
+    INI INI = INIDefault;
+    char name[32];
+
+    for(int x = 0; x < 20; x++)
+    {
+        snprintf(name, sizeof(name), "Section%d", x);
+        INISection *section;
+        TEST((section = INIAddSection(&INI, name)), !=, NULL, ErrorCurrentPrint(); return;);
+
+        for(int y = 0; y < x % 7; y++)
+        {
+            snprintf(name, sizeof(name), "Key%d", y);
+            TEST(INIAddInt(&INI, section, name, x * y), !=, NULL, ErrorCurrentPrint(); return;);
+        }
+    }
+
+    INIKey sectionKey = INIKeyMake("Section13"), pairKey = INIKeyMake("Key5"), missing = INIKeyMake("Key6");
+    TEST(sectionKey.Length, ==, 9);
+
+    // Keys find the same sections and pairs without an index, with one and once frozen
+    for(int pass = 0; pass < 3; pass++)
+    {
+        if(pass == 1)
+            TEST(INIEnableIndex(&INI), ==, 0, ErrorCurrentPrint(););
+        if(pass == 2)
+            TEST(INIFreeze(&INI), ==, 0, ErrorCurrentPrint(););
+
+        INISection *section = INIFindSectionByKey(&INI, &sectionKey);
+        TEST(section, ==, INIFindSection(&INI, "Section13"), continue;);
+        TEST(section, !=, NULL, continue;);
+        TEST(INIFindPairByKey(section, &pairKey), ==, INIFindPair(section, "Key5"));
+        TEST(*INIGetInt(INIFindPairByKey(section, &pairKey)), ==, 65);
+        TEST(INIFindPairByKey(section, &missing), ==, NULL);
+        TEST(INIFindSectionByKey(&INI, &missing), ==, NULL);
+    }
+
+    TEST(INIFindSectionByKey(&INI, NULL), ==, NULL);
+    INIFree(&INI);
+}
+
+// Every pair with the given key has to share one copy of it
+static int TestSharedKey(INI *INI, const char *key)
+{
+    const char *shared = NULL;
+    for(INISection *section = INI->FirstSection; section != NULL; section = section->NextSection)
+    {
+        INIPair *pair = INIFindPair(section, (char *)key);
+        if(pair == NULL)
+            continue;
+        if(shared != NULL && pair->Key != shared)
+            return 0;
+        shared = pair->Key;
+    }
+
+    return shared != NULL;
+}
+
+void TestInterning()
+{
+    const char *source = "Bin/Interned.ini";
+    const char *text = "[A]\nHost = \"a\"\nPort = 1\n[B]\nHost = \"b\"\nPort = 2\n[Port]\nHost = \"c\"\n";
+    TestWriteText(source, text);
+
+    INI INI = INIDefault;
+    TEST(INIRead(&INI, (char *)source), ==, 0, ErrorCurrentPrint(););
+    TEST(TestSharedKey(&INI, "Host"), ==, 0);
+
+    // Names that are already there are shared once interning is enabled, and so are the ones read afterwards
+    TEST(INIEnableInterning(&INI), ==, 0, ErrorCurrentPrint(););
+    TEST(TestSharedKey(&INI, "Host"), ==, 1);
+    TEST(TestSharedKey(&INI, "Port"), ==, 1);
+    TEST(INIFindSection(&INI, "Port")->Name, ==, INIFindPair(INIFindSection(&INI, "A"), "Port")->Key);
+
+    INISection *section;
+    TEST((section = INIAddSection(&INI, "C")), !=, NULL, ErrorCurrentPrint(); return;);
+    TEST(INIAddInt(&INI, section, "Port", 3), !=, NULL);
+    TEST(TestSharedKey(&INI, "Port"), ==, 1);
+
+    INIKey key, sectionKey;
+    TEST(INIInternKey(&INI, "Port", &key), ==, 0, ErrorCurrentPrint(););
+    TEST(INIInternKey(&INI, "B", &sectionKey), ==, 0, ErrorCurrentPrint(););
+    TEST(key.Name, ==, section->LastPair->Key);
+    TEST(*INIGetInt(INIFindPairByKey(INIFindSectionByKey(&INI, &sectionKey), &key)), ==, 2);
+    TEST(INIFindPairByKey(INIFindSection(&INI, "Port"), &key), ==, NULL);
+
+    // Names only added by interning a key are found as well
+    INIKey missing;
+    TEST(INIInternKey(&INI, "Timeout", &missing), ==, 0);
+    TEST(INIFindPairByKey(section, &missing), ==, NULL);
+    TEST(INIAddInt(&INI, section, "Timeout", 5), !=, NULL);
+    TEST(INIFindPairByKey(section, &missing), ==, section->LastPair);
+
+    // The index and a reset keep interning
+    TEST(INIEnableIndex(&INI), ==, 0);
+    TEST(*INIGetInt(INIFindPairByKey(section, &key)), ==, 3);
+    TEST(INIReset(&INI), ==, 0);
+    TEST(INIReadMapped(&INI, (char *)source), ==, 0, ErrorCurrentPrint(););
+    TEST(TestSharedKey(&INI, "Host"), ==, 1);
+    TEST(INIInternKey(&INI, "Host", &key), ==, 0);
+    TEST(strcmp(INIGetString(INIFindPairByKey(INIFindSection(&INI, "Port"), &key)), "c"), ==, 0);
+
+    TEST(INIReset(&INI), ==, 0);
+    TEST(INIReadParallel(&INI, (char *)source, 2), ==, 0, ErrorCurrentPrint(););
+    TEST(TestSharedKey(&INI, "Host"), ==, 1);
+
+    // Frozen INIs have their own copies
+    TEST(INIFreeze(&INI), ==, 0);
+    TEST(INIInternKey(&INI, "Host", &key), ==, -1);
+    TEST(INIFindPair(INIFindSection(&INI, "B"), "Host"), !=, NULL);
+    INIFree(&INI);
+
+    INI = INIDefault;
+    TEST(INIInternKey(&INI, "Host", &key), ==, -1);
+    remove(source);
+}
+
+static void TestCompactCase(int indexed, int interned)
+{
+    INI INI = INIDefault;
+    if(indexed)
+        TEST(INIEnableIndex(&INI), ==, 0);
+    if(interned)
+        TEST(INIEnableInterning(&INI), ==, 0);
+    TEST(INIEnableLazyValues(&INI), ==, 0);
+
+    const char *source = "Bin/Compact.ini";
+    TestWriteText(source, "[A]\nFloat = 1.5\nName = \"Long value\"\n[B]\nKey = 1\n");
+    TEST(INIRead(&INI, (char *)source), ==, 0, ErrorCurrentPrint(); return;);
+    remove(source);
+
+    // Shorter strings reuse the old one, longer ones need a new copy
+    INISection *section = INIFindSection(&INI, "A");
+    INIPair *name = INIFindPair(section, "Name");
+    char *value = INIGetString(name);
+    TEST(INISetString(&INI, name, "Short"), ==, 0);
+    TEST(INIGetString(name), ==, value);
+    TEST(INISetString(&INI, name, "A much longer value than before"), ==, 0);
+    TEST(INIGetString(name), !=, value);
+
+    for(int x = 0; x < 200; x++)
+    {
+        INIPair *pair;
+        TEST((pair = INIAddInt(&INI, section, "Removed", x)), !=, NULL, ErrorCurrentPrint(); return;);
+        TEST(INIRemovePair(section, pair), ==, 0);
+    }
+    TEST(INIRemoveSection(&INI, INIFindSection(&INI, "B")), ==, 0);
+    TEST(INIAddString(&INI, INIAddSection(&INI, "C"), "Key", "Value"), !=, NULL);
+
+    int64_t reclaimed = 0;
+    TEST(INICompact(&INI, &reclaimed), ==, 0, ErrorCurrentPrint(););
+    TEST(reclaimed, >, 0);
+
+    section = INIFindSection(&INI, "A");
+    TEST(INIFindSection(&INI, "B"), ==, NULL);
+    TEST(INIFindPair(section, "Removed"), ==, NULL);
+    TEST(*INIGetFloat(INIFindPair(section, "Float")), ==, 1.5);
+    TEST(strcmp(INIGetString(INIFindPair(section, "Name")), "A much longer value than before"), ==, 0);
+    TEST(strcmp(INIGetString(INIFindPair(INIFindSection(&INI, "C"), "Key")), "Value"), ==, 0);
+    TEST(section->Owner, ==, &INI);
+    if(interned)
+        TEST(TestSharedKey(&INI, "Key"), ==, 1);
+
+    // A compact INI keeps working as before
+    TEST(INIAddInt(&INI, section, "Added", 2), !=, NULL);
+    TEST(*INIGetInt(INIFindPair(section, "Added")), ==, 2);
+    TEST(INICompact(&INI, &reclaimed), ==, 0);
+    TEST(*INIGetInt(INIFindPair(INIFindSection(&INI, "A"), "Added")), ==, 2);
+
+    TEST(INIFreeze(&INI), ==, 0);
+    TEST(INICompact(&INI, NULL), ==, -1);
+    INIFree(&INI);
+}
+
+void TestCompact()
+{
+    TestCompactCase(0, 0);
+    TestCompactCase(1, 0);
+    TestCompactCase(1, 1);
+
+    INI INI = INIDefault;
+    TEST(INICompact(&INI, NULL), ==, 0);
+    TEST(INIAddSection(&INI, "A"), !=, NULL);
+    INIFree(&INI);
+}
+
+void TestOverlay()
+{
+    const char *baseSource = "Bin/OverlayBase.ini", *hostSource = "Bin/OverlayHost.ini";
+    TestWriteText(baseSource, "[Server]\nHost = \"base\"\nPort = 80\nBroken = \"base\"\nRatio = 0.5\n[Log]\nLevel = 1\n");
+    TestWriteText(hostSource, "[Server]\nPort = 8080\nTLS = 1\nBroken = \"x\n[Cache]\nSize = 64\n");
+
+    INI base = INIDefault, host = INIDefault, local = INIDefault;
+    TEST(INIEnableIndex(&base), ==, 0);
+    TEST(INIRead(&base, (char *)baseSource), ==, 0, ErrorCurrentPrint(); return;);
+    TEST(INIRead(&host, (char *)hostSource), ==, 0, ErrorCurrentPrint(); return;);
+    remove(baseSource);
+    remove(hostSource);
+
+    INIOverlay *overlay;
+    TEST((overlay = INIOverlayCreate()), !=, NULL, return;);
+    TEST(INIOverlayAdd(overlay, &base), ==, 0);
+    TEST(INIOverlayAdd(overlay, &host), ==, 0);
+
+    TEST(*INIOverlayFindInt(overlay, "Server", "Port"), ==, 8080);
+    TEST(*INIOverlayFindInt(overlay, "Server", "Port"), ==, 8080);
+    TEST(strcmp(INIOverlayFindString(overlay, "Server", "Host"), "base"), ==, 0);
+    TEST(*INIOverlayFindInt(overlay, "Cache", "Size"), ==, 64);
+    TEST(*INIOverlayFindFloat(overlay, "Server", "Ratio"), ==, 0.5);
+    TEST(INIOverlayFindPair(overlay, "Server", "Missing"), ==, NULL);
+    TEST(INIOverlayFindPair(overlay, "Missing", "Port"), ==, NULL);
+    TEST(INIOverlayFindString(overlay, "Server", "Port"), ==, NULL);
+
+    // Changes to any INI are seen by the next lookup, cached pairs included
+    TEST(INIFindAndRemovePair(INIFindSection(&host, "Server"), "Port"), ==, 0);
+    TEST(*INIOverlayFindInt(overlay, "Server", "Port"), ==, 80);
+    TEST(INIAddString(&local, INIAddSection(&local, "Server"), "Host", "local"), !=, NULL);
+    TEST(INIOverlayAdd(overlay, &local), ==, 0);
+    TEST(strcmp(INIOverlayFindString(overlay, "Server", "Host"), "local"), ==, 0);
+    TEST(INIAddInt(&local, INIFindSection(&local, "Server"), "Port", 443), !=, NULL);
+    TEST(*INIOverlayFindInt(overlay, "Server", "Port"), ==, 443);
+    TEST(INIReset(&local), ==, 0);
+    TEST(strcmp(INIOverlayFindString(overlay, "Server", "Host"), "base"), ==, 0);
+    TEST(INIAddString(&local, INIAddSection(&local, "Server"), "Host", "local"), !=, NULL);
+
+    // The line that failed to parse is still a pair, but not one with a value, so the layer below supplies it
+    TEST(INIFindPair(INIFindSection(&host, "Server"), "Broken"), !=, NULL, return;);
+    TEST(INIFindPair(INIFindSection(&host, "Server"), "Broken")->Type, ==, INITypeInvalid);
+    TEST(strcmp(INIOverlayFindString(overlay, "Server", "Broken"), "base"), ==, 0);
+
+    INI flat = INIDefault;
+    TEST(INIFlatten(overlay, &flat), ==, 0, ErrorCurrentPrint(););
+    INISection *section = INIFindSection(&flat, "Server");
+    TEST(section, ==, flat.FirstSection);
+    TEST(strcmp(section->FirstPair->Key, "Host"), ==, 0);
+    TEST(strcmp(INIGetString(section->FirstPair), "local"), ==, 0);
+    TEST(strcmp(section->FirstPair->NextPair->Key, "TLS"), ==, 0);
+    TEST(*INIFindInt(section, "Port"), ==, 80);
+    TEST(*INIFindInt(section, "TLS"), ==, 1);
+    TEST(strcmp(INIFindString(section, "Broken"), INIOverlayFindString(overlay, "Server", "Broken")), ==, 0);
+    TEST(strcmp(section->LastPair->Key, "Ratio"), ==, 0);
+    TEST(flat.FirstSection->NextSection, ==, INIFindSection(&flat, "Cache"));
+    TEST(*INIFindInt(INIFindSection(&flat, "Log"), "Level"), ==, 1);
+    TEST(flat.LastSection, ==, INIFindSection(&flat, "Log"));
+    TEST(INIFlatten(overlay, &flat), ==, -1);
+
+    INIFree(&flat);
+    INIOverlayFree(overlay);
+    INIFree(&base);
+    INIFree(&host);
+    INIFree(&local);
+}
+
+static void TestFindValuesCase(int mode)
+{
+    INI INI = INIDefault;
+    if(mode == 1)
+        TEST(INIEnableIndex(&INI), ==, 0);
+    TEST(INIEnableLazyValues(&INI), ==, 0);
+
+    const char *source = "Bin/FindValues.ini";
+    TestWriteText(source, "[Other]\nName = \"other\"\n[Server]\nName = \"main\"\nPort = 80\nRatio = 0.25\n");
+    TEST(INIRead(&INI, (char *)source), ==, 0, ErrorCurrentPrint(); return;);
+    remove(source);
+
+    // Enough keys that the table of wanted keys does not fit on the stack
+    INISection *section = INIFindSection(&INI, "Server");
+    char keys[300][8];
+    for(int x = 0; x < 300; x++)
+    {
+        snprintf(keys[x], sizeof(keys[x]), "Key%d", x);
+        TEST(INIAddInt(&INI, section, keys[x], x), !=, NULL);
+    }
+
+    if(mode == 2)
+        TEST(INIFreeze(&INI), ==, 0);
+    section = INIFindSection(&INI, "Server");
+
+    INILookup lookups[] = 
+    {
+        {.Key = "Ratio", .Type = INITypeFloat},
+        {.Key = "Name", .Type = INITypeString},
+        {.Key = "Port", .Type = INITypeString},
+        {.Key = "Missing", .Type = INITypeInt},
+        {.Key = "Name", .Type = INITypeString}
+    };
+    TEST(INIFindValues(section, lookups, 5), ==, 3, ErrorCurrentPrint(););
+    TEST(lookups[0].Status, ==, INILookupStatusFound);
+    TEST(*(double *)lookups[0].Value, ==, 0.25);
+    TEST(strcmp(lookups[1].Value, "main"), ==, 0);
+    TEST(lookups[2].Status, ==, INILookupStatusTypeMismatch);
+    TEST(lookups[2].Pair, ==, INIFindPair(section, "Port"));
+    TEST(lookups[2].Value, ==, NULL);
+    TEST(lookups[3].Status, ==, INILookupStatusMissing);
+    TEST(lookups[3].Pair, ==, NULL);
+    TEST(lookups[4].Value, ==, lookups[1].Value);
+
+    INILookup many[300];
+    for(int x = 0; x < 300; x++)
+        many[x] = (INILookup){.Key = keys[299 - x], .Type = INITypeInt};
+    TEST(INIFindValues(section, many, 300), ==, 300);
+    TEST(*(int64_t *)many[0].Value, ==, 299);
+    TEST(*(int64_t *)many[299].Value, ==, 0);
+
+    TEST(INIFindValues(section, NULL, 0), ==, 0);
+    INIFree(&INI);
+}
+
+void TestFindValues()
+{
+    TestFindValuesCase(0);
+    TestFindValuesCase(1);
+    TestFindValuesCase(2);
+}
+
+enum { StatsReaderCount = 4, StatsReaderLookups = 1000 };
+
+static void *TestStatsReader(void *argument)
+{
+    for(int x = 0; x < StatsReaderLookups; x++)
+        INIFindPair(argument, "Other");
+
+    return NULL;
+}
+
+void TestStats()
+{
+    INI INI = INIDefault;
+    INIStats stats;
+
+    if(INIEnableStats(&INI) != 0)
+    {
+        // Only builds with INI_STATS count
+        TEST(INIGetStats(&INI, &stats), ==, -1);
+        return;
+    }
+
+    const char *text = "[A]\nKey = 1\nBad\n[B\nOther = \"x\"\n";
+    INIStream stream = INIStreamDefault;
+    stream.IOStream = (char *)text;
+    stream.IOStreamCount = strlen(text);
+
+    int code;
+    while((code = INIStreamRead(&INI, &stream)) != INIStreamStatusSuccess)
+        TEST(code, !=, INIStreamStatusFatalFailure, break;);
+    INIStreamFree(&stream);
+
+    TEST(INIGetStats(&INI, &stats), ==, 0, ErrorCurrentPrint(); INIFree(&INI); return;);
+    TEST(stats.Lines, ==, 5);
+    TEST(stats.Bytes, ==, strlen(text));
+    TEST(stats.SectionsAdded, ==, 1);
+    TEST(stats.PairsAdded, ==, 2);
+    TEST(stats.Failures[INIStreamStatusPairParseFailed], ==, 1);
+    TEST(stats.Failures[INIStreamStatusSectionHeaderParseFailed], ==, 1);
+    TEST(stats.ArenaBlocks, ==, 1);
+    TEST(stats.ArenaUsed, >, 0);
+    TEST(stats.ParseSeconds, >, 0);
+
+    // Both keys are found by scanning the section, Other after comparing it with Key
+    uint64_t lookups = stats.Lookups, probes = stats.Probes;
+    TEST(INIFindPair(INI.FirstSection, "Other"), !=, NULL);
+    TEST(INIGetStats(&INI, &stats), ==, 0);
+    TEST(stats.Lookups, ==, lookups + 1);
+    TEST(stats.Probes, ==, probes + 2);
+
+    // Resets keep the counters
+    const char *source = "Bin/Stats.ini";
+    TestWriteText(source, text);
+    TEST(INIReset(&INI), ==, 0);
+    TEST(INIReadParallel(&INI, (char *)source, 2), ==, 0, ErrorCurrentPrint(););
+    TEST(INIGetStats(&INI, &stats), ==, 0);
+    TEST(stats.Lines, ==, 10);
+    TEST(stats.Failures[INIStreamStatusPairParseFailed], ==, 2);
+    TEST(stats.ReadSeconds, >, 0);
+
+    char buffer[256];
+    stream = INIStreamDefault;
+    stream.IOStream = buffer;
+    stream.IOStreamCount = sizeof(buffer);
+    TEST(INIStreamWrite(&INI, &stream), ==, INIStreamStatusSuccess);
+    INIStreamFree(&stream);
+    TEST(INIGetStats(&INI, &stats), ==, 0);
+    TEST(stats.WriteSeconds, >, 0);
+
+    // Readers on several threads count into the same INI without losing any of their lookups
+    lookups = stats.Lookups;
+    pthread_t threads[StatsReaderCount];
+    for(size_t x = 0; x < StatsReaderCount; x++)
+        pthread_create(threads + x, NULL, TestStatsReader, INI.FirstSection);
+    for(size_t x = 0; x < StatsReaderCount; x++)
+        pthread_join(threads[x], NULL);
+    TEST(INIGetStats(&INI, &stats), ==, 0);
+    TEST(stats.Lookups, ==, lookups + StatsReaderCount * StatsReaderLookups);
+
+    INIFree(&INI);
+    TEST(INI.Stats, ==, NULL);
+    remove(source);
+}
+
+void TestLazy()
+{
+    const char *source = "Bin/LazyINI.ini", *eagerOut = "Bin/EagerOut.ini", *lazyOut = "Bin/LazyOut.ini";
+    TestWriteText(source, "[Numbers]\nFloat = 2.50\nHex = 0x1p-2\nInt = 7\nString = \"1.5\"\nLast = -1e-3");
+
+    for(int mapped = 0; mapped < 2; mapped++)
+    {
+        INI eager = INIDefault, lazy = INIDefault;
+        TEST(INIEnableLazyValues(&lazy), ==, 0);
+        TEST(mapped ? INIReadMapped(&eager, (char *)source) : INIRead(&eager, (char *)source), ==, 0, ErrorCurrentPrint(););
+        TEST(mapped ? INIReadMapped(&lazy, (char *)source) : INIRead(&lazy, (char *)source), ==, 0, ErrorCurrentPrint(););
+
+        INISection *section = INIFindSection(&lazy, "Numbers");
+        TEST(section, !=, NULL, INIFree(&eager); INIFree(&lazy); continue;);
+
+        INIPair *pair = INIFindPair(section, "Float");
+        TEST(pair->Type, ==, INITypeFloat);
+        TEST(pair->RawLength, ==, 4);
+        TEST(*INIGetFloat(pair), ==, 2.5);
+        TEST(pair->RawLength, ==, 0);
+        TEST(*INIGetFloat(pair), ==, 2.5);
+
+        TEST(INIFindPair(section, "Int")->RawLength, ==, 0);
+        TEST(*INIFindFloat(section, "Hex"), ==, 0.25);
+        TEST(strcmp(INIFindString(section, "String"), "1.5"), ==, 0);
+
+        // Values that were never read are written the same way
+        TEST(INIWrite(&eager, (char *)eagerOut), ==, 0);
+        TEST(INIWrite(&lazy, (char *)lazyOut), ==, 0);
+        char eagerText[256] = {0}, lazyText[256] = {0};
+        FILE *file = fopen(eagerOut, "r");
+        TEST(file, !=, NULL, return;);
+        fread(eagerText, 1, sizeof(eagerText) - 1, file);
+        fclose(file);
+        TEST((file = fopen(lazyOut, "r")), !=, NULL, return;);
+        fread(lazyText, 1, sizeof(lazyText) - 1, file);
+        fclose(file);
+        TEST(strcmp(eagerText, lazyText), ==, 0, printf("%s\n%s\n", eagerText, lazyText););
+
+        INIFree(&eager);
+        INIFree(&lazy);
+    }
+
+    // Freezing converts what is left
+    INI INI = INIDefault;
+    INIEnableLazyValues(&INI);
+    TEST(INIRead(&INI, (char *)source), ==, 0, ErrorCurrentPrint(););
+    TEST(INIFreeze(&INI), ==, 0, ErrorCurrentPrint(););
+    TEST(INIFindPair(INI.FirstSection, "Last")->RawLength, ==, 0);
+    TEST(*INIFindFloat(INI.FirstSection, "Last"), ==, -1e-3);
+    INIFree(&INI);
+
+    // So does publishing, readers on other threads never write to the pairs
+    INIHandle *handle = INIHandleCreate(1);
+    struct INI *published = malloc(sizeof(*published));
+    TEST(handle != NULL && published != NULL, ==, 1, return;);
+    *published = INIDefault;
+    INIEnableLazyValues(published);
+    TEST(INIRead(published, (char *)source), ==, 0, ErrorCurrentPrint(););
+    TEST(INIFindPair(published->FirstSection, "Float")->RawLength, ==, 4);
+    TEST(INIHandlePublish(handle, published), ==, 0);
+    struct INI *acquired = INIHandleAcquire(handle, 0);
+    TEST(INIFindPair(acquired->FirstSection, "Float")->RawLength, ==, 0);
+    TEST(*INIFindFloat(acquired->FirstSection, "Float"), ==, 2.5);
+    INIHandleRelease(handle, 0);
+    INIHandleFree(handle);
+
+    remove(source);
+    remove(eagerOut);
+    remove(lazyOut);
+}
+
+typedef struct TestReaderContext
+{
+    INIHandle *Handle;
+    size_t Reader;
+    _Atomic int *Done;
+    int Failures;
+} TestReaderContext;
+
+static void *TestReader(void *argument)
+{
+    TestReaderContext *context = argument;
+    int64_t lastVersion = 0;
+
+    while(!*context->Done)
+    {
+        INI *INI = INIHandleAcquire(context->Handle, context->Reader);
+        INISection *section = INI != NULL ? INI->FirstSection : NULL;
+
+        // Both values are written together, a reader seeing them differ would be looking at a freed or half built INI.
+        // Reading repeatedly and yielding keeps the INI held long enough for publishing to run into it
+        for(int x = 0; section != NULL && x < 100; x++)
+        {
+            int64_t *version = INIFindInt(section, "Version"), *copy = INIFindInt(section, "Copy");
+            if(version == NULL || copy == NULL || *version != *copy || *version < lastVersion)
+                context->Failures++;
+            else
+                lastVersion = *version;
+
+            if(x % 10 == 0)
+                sched_yield();
+        }
+
+        INIHandleRelease(context->Handle, context->Reader);
+    }
+
+    return NULL;
+}
+
+void TestHandle()
+{
+    enum { ReaderCount = 4, Versions = 200 };
+
+    INIHandle *handle;
+    TEST((handle = INIHandleCreate(ReaderCount)), !=, NULL, return;);
+    TEST(INIHandleAcquire(handle, 0), ==, NULL);
+    INIHandleRelease(handle, 0);
+    TEST(INIHandleAcquire(handle, ReaderCount), ==, NULL);
+
+    _Atomic int done = 0;
+    pthread_t threads[ReaderCount];
+    TestReaderContext contexts[ReaderCount];
+    for(size_t x = 0; x < ReaderCount; x++)
+    {
+        contexts[x] = (TestReaderContext){handle, x, &done, 0};
+        pthread_create(threads + x, NULL, TestReader, contexts + x);
+    }
+
+    for(int64_t version = 1; version <= Versions; version++)
+    {
+        INI *INI = malloc(sizeof(*INI));
+        TEST(INI, !=, NULL, break;);
+        *INI = INIDefault;
+
+        INISection *section = INIAddSection(INI, "Config");
+        INIAddInt(INI, section, "Version", version);
+        INIAddInt(INI, section, "Copy", version);
+        TEST(INIHandlePublish(handle, INI), ==, 0, ErrorCurrentPrint(););
+        sched_yield();
+    }
+
+    done = 1;
+    for(size_t x = 0; x < ReaderCount; x++)
+    {
+        pthread_join(threads[x], NULL);
+        TEST(contexts[x].Failures, ==, 0);
+    }
+
+    TEST(INIHandleLoad(handle, "Tests/TestINI.ini"), ==, 0, ErrorCurrentPrint(););
+    TestINIValidity(INIHandleAcquire(handle, 0));
+    INIHandleRelease(handle, 0);
+    INIHandleFree(handle);
+}
+
+typedef struct TestChanges
+{
+    int Counts[3];
+    int Matched;
+} TestChanges;
+
+static void TestChangeCallback(void *context, enum INIChange change, const char *sectionName, INIPair *oldPair, INIPair *newPair)
+{
+    TestChanges *changes = context;
+    changes->Counts[change]++;
+
+    if(change == INIChangeModified && strcmp(sectionName, "Section") == 0 && strcmp(oldPair->Key, "Key") == 0 && 
+        strcmp(oldPair->Value, "Value") == 0 && strcmp(newPair->Value, "Changed") == 0)
+        changes->Matched++;
+}
+
+void TestWatcher()
+{
+    const char *source = "Bin/WatchedINI.ini";
+    TestWriteText(source, "[Section]\nKey = \"Value\"\nNumber = 1\nRemoved = 2\n[Other]\nKey = 3\n");
+
+    INIWatcher *watcher;
+    TEST((watcher = INIWatcherCreate((char *)source, NULL)), !=, NULL, ErrorCurrentPrint(); return;);
+
+    TestChanges all = {0}, key = {0};
+    TEST(INIWatcherSubscribe(watcher, NULL, NULL, TestChangeCallback, &all), ==, 0);
+    TEST(INIWatcherSubscribe(watcher, "Section", "Key", TestChangeCallback, &key), ==, 0);
+
+    // Nothing is reported while the content stays the same
+    TEST(INIWatcherCheck(watcher), ==, 0);
+    TestWriteText(source, "[Section]\nKey = \"Value\"\nNumber = 1\nRemoved = 2\n[Other]\nKey = 3\n");
+    TEST(INIWatcherPoll(watcher, 0), ==, 0);
+    TEST(all.Counts[INIChangeAdded] + all.Counts[INIChangeRemoved] + all.Counts[INIChangeModified], ==, 0);
+
+    // The unchanged Other section is skipped, the new one is added as a whole
+    TestWriteText(source, "[Section]\nKey = \"Changed\"\nNumber = 1\nAdded = 4.5\n[Other]\nKey = 3\n[New]\nA = 1\nB = 2\n");
+    TEST(INIWatcherPoll(watcher, 1000), ==, 5, ErrorCurrentPrint(););
+    TEST(all.Counts[INIChangeAdded], ==, 3);
+    TEST(all.Counts[INIChangeRemoved], ==, 1);
+    TEST(all.Counts[INIChangeModified], ==, 1);
+    TEST(all.Matched, ==, 1);
+    TEST(key.Counts[INIChangeModified], ==, 1);
+    TEST(key.Counts[INIChangeAdded] + key.Counts[INIChangeRemoved], ==, 0);
+    TEST(*INIFindFloat(INIFindSection(INIWatcherINI(watcher), "Section"), "Added"), ==, 4.5);
+
+    // A changed type counts as a change, a removed section removes all of its keys
+    TestWriteText(source, "[Section]\nKey = \"Changed\"\nNumber = 1.0\nAdded = 4.5\n[Other]\nKey = 3\n");
+    TEST(INIWatcherCheck(watcher), ==, 3);
+    TEST(all.Counts[INIChangeModified], ==, 2);
+    TEST(all.Counts[INIChangeRemoved], ==, 3);
+    INIWatcherFree(watcher);
+
+    // With a handle every reload is published
+    INIHandle *handle;
+    TEST((handle = INIHandleCreate(1)), !=, NULL, return;);
+    TEST((watcher = INIWatcherCreate((char *)source, handle)), !=, NULL, ErrorCurrentPrint(); INIHandleFree(handle); return;);
+    TEST(INIHandleAcquire(handle, 0), ==, INIWatcherINI(watcher));
+    INIHandleRelease(handle, 0);
+
+    TestWriteText(source, "[Other]\nKey = 4\n");
+    TEST(INIWatcherCheck(watcher), ==, 4);
+    TEST(INIHandleAcquire(handle, 0), ==, INIWatcherINI(watcher));
+    TEST(*INIFindInt(INIFindSection(INIHandleAcquire(handle, 0), "Other"), "Key"), ==, 4);
+    INIHandleRelease(handle, 0);
+
+    // The file is read once into a buffer that grows past its first size, and the last line has no newline
+    char *large;
+    const char *line = "Filler = \"0123456789012345678901234567890123456789\"\n";
+    size_t lineLength = strlen(line), count = 2000;
+    TEST((large = malloc(lineLength * count + 64)), !=, NULL, return;);
+    strcpy(large, "[Other]\n");
+    for(size_t x = 0; x < count; x++)
+        strcat(large + 8 + x * lineLength, line);
+    strcat(large, "Key = 5");
+    TestWriteText(source, large);
+    free(large);
+
+    TEST(INIWatcherCheck(watcher), ==, 2);
+    TEST(*INIFindInt(INIFindSection(INIWatcherINI(watcher), "Other"), "Key"), ==, 5);
+
+    INIWatcherFree(watcher);
+    INIHandleFree(handle);
+    remove(source);
+}
+
+// Returns the number of sections and pairs that differ in name, type, value or order
+static size_t TestINIDifferences(INI *a, INI *b)
+{
+    size_t differences = 0;
+    INISection *sectionA = a->FirstSection, *sectionB = b->FirstSection;
+
+    for(; sectionA != NULL && sectionB != NULL; sectionA = ININextSection(a, sectionA), sectionB = ININextSection(b, sectionB))
+    {
+        // Frozen sections a clone shares belong to the frozen contents
+        if(strcmp(sectionA->Name, sectionB->Name) != 0 || (b->Shared == NULL && sectionB->Owner != b) || INIFindSection(b, sectionB->Name) != sectionB)
+            differences++;
+
+        INIPair *pairA = sectionA->FirstPair, *pairB = sectionB->FirstPair;
+        for(; pairA != NULL && pairB != NULL; pairA = pairA->NextPair, pairB = pairB->NextPair)
+        {
+            if(strcmp(pairA->Key, pairB->Key) != 0 || pairA->Type != pairB->Type || INIFindPair(sectionB, pairB->Key) != pairB)
+                differences++;
+            else if(pairA->Type == INITypeString ? strcmp(pairA->Value, pairB->Value) != 0 : memcmp(&pairA->Int, &pairB->Int, sizeof(pairA->Int)) != 0)
+                differences++;
+        }
+
+        differences += pairA != NULL || pairB != NULL;
+    }
+
+    return differences + (sectionA != NULL || sectionB != NULL) + (b->LastSection != NULL && ININextSection(b, b->LastSection) != NULL);
+}
+
+static void TestParallelCase(const char *source, int indexed, int existing)
+{
+    INI expected = INIDefault, INI = INIDefault;
+    struct INI *both[] = {&expected, &INI};
+
+    for(int x = 0; x < 2; x++)
+    {
+        if(indexed)
+            TEST(INIEnableIndex(both[x]), ==, 0);
+
+        // Leading pairs go to the last existing section, and the first fallback name is already taken
+        if(existing)
+        {
+            INIAddInt(both[x], INIAddSection(both[x], "ParseFailed_0"), "K1", 1);
+            INIAddInt(both[x], INIAddSection(both[x], "S5"), "K1", 1);
+        }
+    }
+
+    TEST(INIRead(&expected, (char *)source), ==, 0, ErrorCurrentPrint(););
+
+    for(int threads = 1; threads <= 8; threads *= 2)
+    {
+        INIReset(&INI);
+        if(existing)
+        {
+            INIAddInt(&INI, INIAddSection(&INI, "ParseFailed_0"), "K1", 1);
+            INIAddInt(&INI, INIAddSection(&INI, "S5"), "K1", 1);
+        }
+
+        TEST(INIReadParallel(&INI, (char *)source, threads), ==, 0, ErrorCurrentPrint(););
+        TEST(TestINIDifferences(&expected, &INI), ==, 0, printf("%d threads, indexed %d, existing %d\n", threads, indexed, existing););
+    }
+
+    INIFree(&expected);
+    INIFree(&INI);
+}
+
+void TestParallel()
+{
+    const char *source = "Bin/ParallelINI.ini";
+    FILE *file = fopen(source, "w");
+    TEST(file, !=, NULL, return;);
+
+    // Repeated section names and keys, broken headers and a section named like a fallback end up in different chunks
+    uint64_t state = 2463534242u;
+    fputs("K0 = 1\nK1 = 2\n", file);
+    for(int x = 0; x < 6000; x++)
+    {
+        uint64_t random = TestRandom(&state);
+        if(random % 97 == 0)
+            fputs("[Broken\n", file);
+        else if(random % 89 == 0)
+            fprintf(file, "[ParseFailed_%d]\n", (int)(random >> 8) % 8);
+        else
+            fprintf(file, "%s[S%d]\n", random % 7 == 0 ? "  " : "", (int)((random >> 8) % 5000));
+
+        for(int y = (random >> 20) % 5; y > 0; y--)
+        {
+            random = TestRandom(&state);
+            if(random % 3 == 0)
+                fprintf(file, "K%d = \"%0*d\"\n", (int)(random >> 8) % 6, 200, (int)random % 1000);
+            else if(random % 3 == 1)
+                fprintf(file, "K%d = %d\n", (int)(random >> 8) % 6, (int)random % 1000);
+            else
+                fprintf(file, "K%d = %d.5\n", (int)(random >> 8) % 6, (int)random % 1000);
+        }
+    }
+
+    fputs("[Last]\nK0 = 1", file);
+    fclose(file);
+
+    TestParallelCase(source, 0, 0);
+    TestParallelCase(source, 1, 0);
+    TestParallelCase(source, 0, 1);
+    TestParallelCase(source, 1, 1);
+    remove(source);
+}
+
+static long TestFileSize(const char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    if(file == NULL)
+        return -1;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// Reads the file into a new INI, with its journal if there is one
+static void TestJournalRead(INI *INI, const char *source, int journaled)
+{
+    *INI = INIDefault;
+    if(journaled)
+        TEST(INIEnableJournal(INI, INIJournalSyncNone, 0), ==, 0);
+    TEST(INIRead(INI, (char *)source), ==, 0, ErrorCurrentPrint(););
+}
+
+void TestJournal()
+{
+    const char *source = "Bin/Journaled.ini", *log = "Bin/Journaled.ini.journal";
+    TestWriteText(source, "[Server]\nHost = \"base\"\nPort = 80\nOld = 1\n[Removed]\nKey = 1\n");
+    remove(log);
+
+    INI INI = INIDefault, copy, plain;
+    TEST(INIEnableJournal(&INI, INIJournalSyncAlways, 0), ==, 0);
+    TEST(INIRead(&INI, (char *)source), ==, 0, ErrorCurrentPrint(); return;);
+
+    INISection *section = INIFindSection(&INI, "Server");
+    TEST(INIFindAndSetString(&INI, section, "Host", "journaled"), ==, 0);
+    TEST(INIFindAndSetInt(&INI, section, "Port", 8080), ==, 0);
+    TEST(INIAddFloat(&INI, section, "Ratio", 0.5), !=, NULL);
+    TEST(INIFindAndRemovePair(section, "Old"), ==, 0);
+    TEST(INIRemoveSection(&INI, INIFindSection(&INI, "Removed")), ==, 0);
+    TEST(INIAddSection(&INI, "Empty"), !=, NULL);
+    TEST(INIAddInt(&INI, INIAddSection(&INI, "New"), "Key", 2), !=, NULL);
+
+    // The file is left alone, reading it with its journal gives the changed INI
+    TestJournalRead(&plain, source, 0);
+    TEST(*INIFindInt(INIFindSection(&plain, "Server"), "Port"), ==, 80);
+    INIFree(&plain);
+
+    TestJournalRead(&copy, source, 1);
+    TEST(TestINIDifferences(&INI, &copy), ==, 0);
+    TEST(strcmp(INIFindString(INIFindSection(&copy, "Server"), "Host"), "journaled"), ==, 0);
+    TEST(INIFindSection(&copy, "Removed"), ==, NULL);
+    TEST(INIFindSection(&copy, "Empty"), !=, NULL);
+    INIFree(&copy);
+
+    // A record cut short by a crash is dropped and written over
+    long logSize = TestFileSize(log);
+    FILE *file = fopen(log, "ab");
+    TEST(file, !=, NULL, return;);
+    fwrite("\x20\0\0\0\1\2", 1, 6, file);
+    fclose(file);
+
+    TestJournalRead(&copy, source, 1);
+    TEST(TestINIDifferences(&INI, &copy), ==, 0);
+    TEST(TestFileSize(log), ==, logSize);
+    TEST(INIFindAndSetInt(&copy, INIFindSection(&copy, "New"), "Key", 3), ==, 0);
+    TEST(INIJournalFlush(&copy), ==, 0);
+    INIFree(&copy);
+
+    TEST(INIReset(&INI), ==, 0);
+    TEST(INIRead(&INI, (char *)source), ==, 0, ErrorCurrentPrint(););
+    TEST(*INIFindInt(INIFindSection(&INI, "New"), "Key"), ==, 3);
+
+    // Compacting moves everything into the file and empties the log
+    TEST(INIJournalCompact(&INI), ==, 0, ErrorCurrentPrint(););
+    TEST(TestFileSize(log), <, logSize);
+    TestJournalRead(&plain, source, 0);
+    TEST(TestINIDifferences(&INI, &plain), ==, 0);
+    INIFree(&plain);
+
+    // A log past its limit is compacted by the next change
+    TEST(INIEnableJournal(&INI, INIJournalSyncNone, 64), ==, 0);
+    section = INIFindSection(&INI, "Server");
+    for(int x = 0; x < 100; x++)
+        TEST(INISetInt(&INI, INIFindPair(section, "Port"), x), ==, 0);
+    TEST(TestFileSize(log), <, 200);
+
+    TestJournalRead(&copy, source, 1);
+    TEST(*INIFindInt(INIFindSection(&copy, "Server"), "Port"), ==, 99);
+    INIFree(&copy);
+
+    TEST(INIFreeze(&INI), ==, 0);
+    TEST(INIJournalCompact(&INI), ==, -1);
+    INIFree(&INI);
+
+    INI = INIDefault;
+    TEST(INIJournalFlush(&INI), ==, -1);
+    remove(source);
+    remove(log);
+}
+
+void TestClone()
+{
+    INI base = INIDefault, a, b, c;
+    INISection *server = INIAddSection(&base, "Server");
+    char key[16];
+    for(int x = 0; x < 12; x++)
+    {
+        sprintf(key, "Key%d", x);
+        TEST(INIAddInt(&base, server, key, x), !=, NULL);
+    }
+    TEST(INIAddString(&base, server, "Host", "base"), !=, NULL);
+    TEST(INIAddInt(&base, INIAddSection(&base, "Log"), "Level", 1), !=, NULL);
+    TEST(INIAddSection(&base, "Empty"), !=, NULL);
+
+    // An INI that is not frozen is frozen into contents only the clone has, and left as it is
+    TEST(INIClone(&base, &a), ==, 0, ErrorCurrentPrint(); return;);
+    TEST(base.Frozen, ==, NULL);
+    TEST(TestINIDifferences(&base, &a), ==, 0);
+    TEST(INIAddSection(&base, "Other"), !=, NULL);
+    TEST(INIFindSection(&a, "Other"), ==, NULL);
+    TEST(INIRemoveSection(&base, INIFindSection(&base, "Other")), ==, 0);
+    TEST(INIAddInt(&a, INIFindSection(&a, "Log"), "Extra", 2), !=, NULL);
+    TEST(INIFindPair(INIFindSection(&base, "Log"), "Extra"), ==, NULL);
+    INIFree(&a);
+
+    TEST(INIFreeze(&base), ==, 0);
+    TEST(INIClone(&base, &a), ==, 0, ErrorCurrentPrint(); return;);
+    TEST(INIClone(&base, &b), ==, 0, ErrorCurrentPrint(); return;);
+    TEST(a.FirstSection, ==, base.FirstSection);
+
+    INISection *serverA = INIFindSection(&a, "Server"), *serverB = INIFindSection(&b, "Server");
+    TEST(*INIFindInt(serverA, "Key11"), ==, 11);
+    TEST(serverA, ==, serverB);
+
+    // Pairs and sections found before a change are the shared ones
+    INIPair *host = INIFindPair(serverA, "Host");
+    TEST(INISetString(&a, host, "a"), ==, 0, ErrorCurrentPrint(););
+    TEST(strcmp(INIGetString(host), "base"), ==, 0);
+    TEST(strcmp(INIFindString(serverA, "Host"), "base"), ==, 0);
+    serverA = INIFindSection(&a, "Server");
+    TEST(strcmp(INIFindString(serverA, "Host"), "a"), ==, 0);
+    TEST(INISetString(&a, host, "ab"), ==, 0);
+    TEST(strcmp(INIFindString(serverA, "Host"), "ab"), ==, 0);
+    TEST(*INIFindInt(serverA, "Key11"), ==, 11);
+    TEST(strcmp(INIFindString(serverB, "Host"), "base"), ==, 0);
+    TEST(strcmp(INIFindString(INIFindSection(&base, "Server"), "Host"), "base"), ==, 0);
+    TEST(INIFindSection(&a, "Log"), ==, INIFindSection(&base, "Log"));
+
+    // Pairs of a shared section are removed from the clone's copy of it, which only the INI can tell the section belongs to
+    TEST(INIRemovePair(serverB, INIFindPair(serverB, "Key0")), ==, -1);
+    TEST(INIRemovePairFrom(&b, serverB, INIFindPair(serverB, "Key0")), ==, 0, ErrorCurrentPrint(););
+    TEST(INIFindPair(serverB, "Key0"), !=, NULL);
+    serverB = INIFindSection(&b, "Server");
+    TEST(INIFindPair(serverB, "Key0"), ==, NULL);
+    TEST(INIFindAndRemovePair(serverB, "Key1"), ==, 0);
+    TEST(INIFindPair(serverB, "Key1"), ==, NULL);
+    TEST(INIFindPair(serverA, "Key0"), !=, NULL);
+    TEST(INIAddInt(&b, INIFindSection(&b, "Log"), "Extra", 5), !=, NULL);
+    TEST(INIFindPair(INIFindSection(&a, "Log"), "Extra"), ==, NULL);
+    TEST(INIRemoveSection(&a, INIFindSection(&a, "Log")), ==, 0);
+    TEST(INIFindSection(&a, "Log"), ==, NULL);
+    TEST(INIFindSection(&b, "Log"), !=, NULL);
+    TEST(INIAddString(&a, INIAddSection(&a, "New"), "Key", "new"), !=, NULL);
+
+    // Only the changed sections are copied, the others stay in the order of the frozen list
+    TEST(INIFindSection(&a, "Empty"), ==, INIFindSection(&base, "Empty"));
+    const char *order[] = {"Server", "Empty", "New"};
+    int count = 0;
+    for(INISection *section = a.FirstSection; section != NULL; section = ININextSection(&a, section), count++)
+        TEST(count < 3 && strcmp(section->Name, order[count]) == 0, ==, 1);
+    TEST(count, ==, 3);
+    TEST(a.LastSection, ==, INIFindSection(&a, "New"));
+
+    // A clone of a clone copies what the first one changed, so later changes to it are not seen
+    TEST(INIClone(&a, &c), ==, 0, ErrorCurrentPrint(); return;);
+    TEST(TestINIDifferences(&a, &c), ==, 0);
+    TEST(INIFindAndSetString(&a, serverA, "Host", "x"), ==, 0);
+    TEST(INIFindAndSetString(&a, INIFindSection(&a, "New"), "Key", "y"), ==, 0);
+    TEST(strcmp(INIFindString(INIFindSection(&c, "Server"), "Host"), "ab"), ==, 0);
+    TEST(strcmp(INIFindString(INIFindSection(&c, "New"), "Key"), "new"), ==, 0);
+
+    // Parallel reads into a clone see its frozen sections too, and copy only the last one for the pairs before the first header
+    const char *source = "Bin/Clone.ini";
+    TestWriteText(source, "Lead = 3\n[Server]\nExtra = 1\n[Added]\nKey = 2\n");
+    INI d;
+    TEST(INIClone(&base, &d), ==, 0, ErrorCurrentPrint(); return;);
+    TEST(INIReadParallel(&d, (char *)source, 2), ==, 0, ErrorCurrentPrint(););
+    TEST(*INIFindInt(INIFindSection(&d, "Empty"), "Lead"), ==, 3);
+    TEST(INIFindPair(INIFindSection(&d, "Server"), "Extra"), ==, NULL);
+    TEST(*INIFindInt(INIFindSection(&d, "Server"), "Key11"), ==, 11);
+    TEST(*INIFindInt(INIFindSection(&d, "ParseFailed_0"), "Extra"), ==, 1);
+    TEST(*INIFindInt(INIFindSection(&d, "Added"), "Key"), ==, 2);
+    TEST(INIFindPair(INIFindSection(&base, "Empty"), "Lead"), ==, NULL);
+    TEST(INIFindSection(&d, "Log"), ==, INIFindSection(&base, "Log"));
+    INIFree(&d);
+    remove(source);
+
+    // Removing the first and last sections moves the ends of the list to the ones the clone still has
+    TEST(INIClone(&base, &d), ==, 0, ErrorCurrentPrint(); return;);
+    TEST(INIRemoveSection(&d, d.FirstSection), ==, 0);
+    TEST(INIRemoveSection(&d, d.LastSection), ==, 0);
+    TEST(d.FirstSection, ==, INIFindSection(&base, "Log"));
+    TEST(d.LastSection, ==, d.FirstSection);
+    TEST(ININextSection(&d, d.FirstSection), ==, NULL);
+    TEST(INIAddSection(&d, "Server"), !=, NULL);
+    TEST(ININextSection(&d, d.FirstSection), ==, INIFindSection(&d, "Server"));
+    TEST(INIRemoveSection(&d, INIFindSection(&d, "Log")), ==, 0);
+    TEST(d.FirstSection, ==, INIFindSection(&d, "Server"));
+    TEST(d.LastSection, ==, d.FirstSection);
+    TEST(INIRemoveSection(&d, d.FirstSection), ==, 0);
+    TEST(d.FirstSection, ==, NULL);
+    TEST(d.LastSection, ==, NULL);
+    INIFree(&d);
+
+    // The shared contents outlive the INI they were made from
+    INIFree(&base);
+    TEST(*INIFindInt(INIFindSection(&b, "Server"), "Key5"), ==, 5);
+    TEST(*INIFindInt(INIFindSection(&b, "Log"), "Level"), ==, 1);
+    TEST(INIFreeze(&b), ==, 0);
+    TEST(*INIFindInt(INIFindSection(&b, "Log"), "Extra"), ==, 5);
+    TEST(INICompact(&c, NULL), ==, 0);
+    TEST(*INIFindInt(INIFindSection(&c, "Server"), "Key11"), ==, 11);
+
+    INIFree(&a);
+    INIFree(&b);
+    INIFree(&c);
+}
+
+typedef struct TestConfig
+{
+    char Host[16];
+    int64_t Port;
+    double Ratio;
+    double Scale;
+    char Name[4];
+    int64_t Mistyped;
+    char Fallback[8];
+    int64_t Required;
+} TestConfig;
+
+static const INIField TestConfigFields[] =
+{
+    INIFieldString(TestConfig, Host, "Server", "Host", NULL),
+    INIFieldInt(TestConfig, Port, "Server", "Port", 80),
+    INIFieldFloat(TestConfig, Ratio, "Server", "Ratio", 1),
+    INIFieldFloat(TestConfig, Scale, "Server", "Scale", 1),
+    INIFieldString(TestConfig, Name, "Other", "Name", ""),
+    INIFieldInt(TestConfig, Mistyped, "Other", "Mistyped", 7),
+    INIFieldString(TestConfig, Fallback, "Other", "Fallback", "default"),
+    INIFieldRequired(TestConfig, Required, "Missing", "Required", INITypeInt)
+};
+
+static void TestBindCheck(const TestConfig *config, const enum INILookupStatus *statuses)
+{
+    TEST(strcmp(config->Host, "example"), ==, 0);
+    TEST(config->Port, ==, 8080);
+    TEST(config->Ratio, ==, 0.25);
+    TEST(config->Scale, ==, 2);
+    TEST(strcmp(config->Fallback, "default"), ==, 0);
+
+    enum INILookupStatus expected[] = {INILookupStatusFound, INILookupStatusFound, INILookupStatusFound, INILookupStatusFound, 
+        INILookupStatusTooLong, INILookupStatusTypeMismatch, INILookupStatusMissing, INILookupStatusMissing};
+    for(size_t x = 0; x < sizeof(expected) / sizeof(*expected); x++)
+        TEST(statuses[x], ==, expected[x]);
+}
+
+typedef struct TestRepeat
+{
+    int64_t X;
+    int64_t Y;
+    int64_t Repeated;
+    int64_t Broken;
+} TestRepeat;
+
+static const INIField TestRepeatFields[] =
+{
+    INIFieldInt(TestRepeat, X, "A", "x", 0),
+    INIFieldInt(TestRepeat, Y, "A", "y", 7),
+    INIFieldInt(TestRepeat, Repeated, "ParseFailed_0", "y", 0),
+    INIFieldInt(TestRepeat, Broken, "ParseFailed_1", "z", 0)
+};
+
+// A repeated or broken header starts a section of its own, which INIRead names like one that failed to parse
+static void TestBindRepeated()
+{
+    const char *source = "Bin/BindRepeated.ini";
+    TestWriteText(source, "[A]\nx = 1\n[B]\n[A]\ny = 5\n[C\nz = 3\n");
+
+    size_t count = sizeof(TestRepeatFields) / sizeof(*TestRepeatFields);
+    TestRepeat fromINI = {0}, fromFile = {0};
+
+    INI INI = INIDefault;
+    TEST(INIRead(&INI, (char *)source), ==, 0, ErrorCurrentPrint(););
+    TEST(INIBind(&INI, TestRepeatFields, count, &fromINI, NULL), ==, 0, ErrorCurrentPrint(););
+    TEST(INIBindFile((char *)source, TestRepeatFields, count, &fromFile, NULL), ==, 0, ErrorCurrentPrint(););
+
+    TEST(fromINI.X, ==, 1);
+    TEST(fromINI.Y, ==, 7);
+    TEST(fromINI.Repeated, ==, 5);
+    TEST(fromINI.Broken, ==, 3);
+    TEST(memcmp(&fromINI, &fromFile, sizeof(fromINI)), ==, 0);
+
+    INIFree(&INI);
+    remove(source);
+}
+
+void TestBind()
+{
+    const char *source = "Bin/Bind.ini";
+    TestWriteText(source, "[Server]\nHost = \"example\"\nPort = 8080\nRatio = 0.25\nScale = 2\nOther = 1\n"
+        "[Other]\nName = \"long\"\nMistyped = \"text\"\n[Server]\nPort = 1\n");
+
+    size_t count = sizeof(TestConfigFields) / sizeof(*TestConfigFields);
+    enum INILookupStatus statuses[sizeof(TestConfigFields) / sizeof(*TestConfigFields)];
+    TestConfig config = {0};
+
+    INI INI = INIDefault;
+    TEST(INIRead(&INI, (char *)source), ==, 0, ErrorCurrentPrint(); return;);
+    TEST(INIBind(&INI, TestConfigFields, count, &config, statuses), ==, 3, ErrorCurrentPrint(););
+    TestBindCheck(&config, statuses);
+
+    // The file gives the same result without an INI
+    memset(&config, 0, sizeof(config));
+    TEST(INIBindFile((char *)source, TestConfigFields, count, &config, statuses), ==, 3, ErrorCurrentPrint(););
+    TestBindCheck(&config, statuses);
+
+    // Members of the wrong size are caught
+    INIField wrong = INIFieldInt(TestConfig, Host, "Server", "Host", 0);
+    TEST(INIBind(&INI, &wrong, 1, &config, NULL), ==, -1);
+    TEST(INIBindFile((char *)source, TestConfigFields, 4, &config, NULL), ==, 0);
+
+    INIFree(&INI);
+    remove(source);
+
+    TestBindRepeated();
 }
 
 int main()
@@ -33,7 +1655,6 @@ int main()
     TEST(code, ==, 0, ErrorCurrentPrint(););
 
     TestINIValidity(&INI);
-    INIFree(&INI);
 
     INISection *section = INI.FirstSection;
     INIPair *pair;
@@ -42,11 +1663,12 @@ int main()
 
     INIRemovePair(section, pair);
     TEST(section->FirstPair, ==, pair->NextPair);
+    INIFree(&INI);
 
     INI = INIDefault;
     TEST((section = INIAddSection(&INI, "Section")), !=, NULL, ErrorCurrentPrint(););
     TEST(INIAddString(&INI, section, "Key", "Value"), !=, NULL, ErrorCurrentPrint(););
-    TEST(INIAddFloat(&INI, section, "Number", 1), !=, NULL, ErrorCurrentPrint(););
+    TEST(INIAddInt(&INI, section, "Number", 1), !=, NULL, ErrorCurrentPrint(););
     
     TestINIValidity(&INI);
     
@@ -61,5 +1683,35 @@ int main()
     TEST(strcmp(INIString, buffer), ==, 0);
     fclose(file);
 
+    INI = INIDefault;
+    code = INIReadMapped(&INI, "Tests/TestINI.ini");
+    TEST(code, ==, 0, ErrorCurrentPrint(););
+    TestINIValidity(&INI);
+    INIFree(&INI);
+
+    TestIndex();
+    TestAppend();
+    TestStreamChunks();
+    TestWriteChunks();
+    TestParse();
+    TestArena();
+    TestNumbers();
+    TestFloats();
+    TestBinary();
+    TestFreeze();
+    TestKeys();
+    TestInterning();
+    TestCompact();
+    TestOverlay();
+    TestFindValues();
+    TestStats();
+    TestLazy();
+    TestHandle();
+    TestWatcher();
+    TestParallel();
+    TestJournal();
+    TestClone();
+    TestBind();
+
     TestsEnd();
 }
\ No newline at end of file